@@ -0,0 +1,237 @@
+// Одинаковые операции над Vector, std::vector, GapVector и ThinVector, чтобы бенчмарки гоняли один и тот же код
+#pragma once
+
+#include "gap_vector.h"
+#include "thin_vector.h"
+#include "vector.h"
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace bench_ops {
+
+template <typename T, typename S, typename A, typename Value>
+void Append(Vector<T, S, A>& v, Value&& value) {
+    v.EmplaceBack(std::forward<Value>(value));
+}
+
+template <typename T, typename Value>
+void Append(std::vector<T>& v, Value&& value) {
+    v.emplace_back(std::forward<Value>(value));
+}
+
+template <typename T, typename S, typename A, typename Value>
+void InsertAt(Vector<T, S, A>& v, size_t index, Value&& value) {
+    v.Emplace(v.begin() + index, std::forward<Value>(value));
+}
+
+template <typename T, typename Value>
+void InsertAt(std::vector<T>& v, size_t index, Value&& value) {
+    v.emplace(v.begin() + index, std::forward<Value>(value));
+}
+
+template <typename T, typename S, typename A>
+void EraseAt(Vector<T, S, A>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T, typename S, typename A>
+void PopBack(Vector<T, S, A>& v) {
+    v.PopBack();
+}
+
+template <typename T>
+void PopBack(std::vector<T>& v) {
+    v.pop_back();
+}
+
+template <typename T, typename S, typename A>
+void Reserve(Vector<T, S, A>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T, typename S, typename A>
+void Resize(Vector<T, S, A>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename T>
+void Resize(std::vector<T>& v, size_t size) {
+    v.resize(size);
+}
+
+// У Vector нет отдельного сжатия: копия выделяет ровно Size() элементов
+template <typename T, typename S, typename A>
+void ShrinkToFit(Vector<T, S, A>& v) {
+    Vector<T, S, A>(v).Swap(v);
+}
+
+template <typename T>
+void ShrinkToFit(std::vector<T>& v) {
+    v.shrink_to_fit();
+}
+
+template <typename T, typename S, typename A>
+size_t Size(const Vector<T, S, A>& v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t Size(const std::vector<T>& v) {
+    return v.size();
+}
+
+template <typename T, typename S, typename A>
+size_t Capacity(const Vector<T, S, A>& v) {
+    return v.Capacity();
+}
+
+template <typename T>
+size_t Capacity(const std::vector<T>& v) {
+    return v.capacity();
+}
+
+template <typename T, typename S, typename A>
+void EraseRange(Vector<T, S, A>& v, size_t index, size_t count) {
+    v.Erase(v.begin() + index, v.begin() + index + count);
+}
+
+template <typename T>
+void EraseRange(std::vector<T>& v, size_t index, size_t count) {
+    v.erase(v.begin() + index, v.begin() + index + count);
+}
+
+// Удаление с переносом последнего элемента на место удалённого
+template <typename T, typename S, typename A>
+void EraseUnorderedAt(Vector<T, S, A>& v, size_t index) {
+    v.EraseUnordered(v.begin() + index);
+}
+
+template <typename T>
+void EraseUnorderedAt(std::vector<T>& v, size_t index) {
+    if (index + 1 != v.size()) {
+        v[index] = std::move(v.back());
+    }
+    v.pop_back();
+}
+
+template <typename T, typename S, typename A>
+void Swap(Vector<T, S, A>& lhs, Vector<T, S, A>& rhs) {
+    lhs.Swap(rhs);
+}
+
+template <typename T>
+void Swap(std::vector<T>& lhs, std::vector<T>& rhs) {
+    lhs.swap(rhs);
+}
+
+// GapVector: вставки и удаления возле одного места дешевле, чем у Vector
+template <typename T, typename Value>
+void Append(GapVector<T>& v, Value&& value) {
+    v.EmplaceBack(std::forward<Value>(value));
+}
+
+template <typename T, typename Value>
+void InsertAt(GapVector<T>& v, size_t index, Value&& value) {
+    v.Emplace(v.cbegin() + index, std::forward<Value>(value));
+}
+
+template <typename T>
+void EraseAt(GapVector<T>& v, size_t index) {
+    v.Erase(v.cbegin() + index);
+}
+
+// Поэлементно от конца диапазона: каждое удаление поглощается зазором без сдвига
+template <typename T>
+void EraseRange(GapVector<T>& v, size_t index, size_t count) {
+    for (size_t i = index + count; i-- > index;) {
+        v.Erase(v.cbegin() + i);
+    }
+}
+
+template <typename T>
+void EraseUnorderedAt(GapVector<T>& v, size_t index) {
+    if (index + 1 != v.Size()) {
+        v[index] = std::move(v[v.Size() - 1]);
+    }
+    v.PopBack();
+}
+
+template <typename T>
+void PopBack(GapVector<T>& v) {
+    v.PopBack();
+}
+
+template <typename T>
+void Reserve(GapVector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Resize(GapVector<T>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename T>
+void Swap(GapVector<T>& lhs, GapVector<T>& rhs) {
+    lhs.Swap(rhs);
+}
+
+template <typename T>
+size_t Size(const GapVector<T>& v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t Capacity(const GapVector<T>& v) {
+    return v.Capacity();
+}
+
+// ThinVector: тот же интерфейс, что у Vector, но один указатель на экземпляр
+template <typename T, typename Value>
+void Append(ThinVector<T>& v, Value&& value) {
+    v.EmplaceBack(std::forward<Value>(value));
+}
+
+template <typename T>
+void PopBack(ThinVector<T>& v) {
+    v.PopBack();
+}
+
+template <typename T>
+void Reserve(ThinVector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Resize(ThinVector<T>& v, size_t size) {
+    v.Resize(size);
+}
+
+template <typename T>
+void ShrinkToFit(ThinVector<T>& v) {
+    ThinVector<T>(v).Swap(v);
+}
+
+template <typename T>
+size_t Size(const ThinVector<T>& v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t Capacity(const ThinVector<T>& v) {
+    return v.Capacity();
+}
+
+}  // namespace bench_ops
@@ -0,0 +1,392 @@
+// Расход памяти Vector, Vector<T, uint32_t>, ThinVector и std::vector на типовых нагрузках: полезные байты, вместимость,
+// незанятая вместимость (slack), байты кучи по mallinfo2, свободная память внутри кучи
+// (фрагментация), прирост и пик RSS.
+//
+// Каждая пара «нагрузка × контейнер × политика роста» выполняется в отдельном дочернем
+// процессе, чтобы пик RSS и состояние кучи не зависели от предыдущих прогонов.
+// Политики роста моделируются поверх контейнера: Reserve с нужной вместимостью перед
+// вставкой в заполненный контейнер либо сжатие копией после построения.
+//
+// Для списков смежности дополнительно меряются строки в VectorArena и результат Freeze
+// в JaggedVector, после которого арена освобождена
+#include "container_ops.h"
+#include "../jagged_vector.h"
+#include "../vector_arena.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+using namespace bench_ops;
+
+enum class Growth {
+    Native,     // собственная политика контейнера, удвоение
+    Factor15,   // рост в полтора раза
+    Shrink,     // удвоение, затем сжатие до размера
+};
+
+const char* GrowthName(Growth growth) {
+    switch (growth) {
+        case Growth::Native:
+            return "native-2x";
+        case Growth::Factor15:
+            return "1.5x";
+        case Growth::Shrink:
+            return "2x+shrink";
+    }
+    return "";
+}
+
+template <typename C, typename Value>
+void Push(C& c, Value&& value, Growth growth) {
+    const size_t size = Size(c);
+    if (growth == Growth::Factor15 && size == Capacity(c)) {
+        Reserve(c, size + size / 2 + 1);
+    }
+    Append(c, std::forward<Value>(value));
+}
+
+template <typename C>
+void Finish(C& c, Growth growth) {
+    if (growth == Growth::Shrink) {
+        ShrinkToFit(c);
+    }
+}
+
+// Полезные байты и вместимость, включая вложенные контейнеры
+struct Usage {
+    uint64_t payload = 0;
+    uint64_t capacity = 0;
+};
+
+template <typename C>
+void Account(const C& c, Usage& usage) {
+    using Value = std::decay_t<decltype(*c.begin())>;
+    usage.payload += Size(c) * sizeof(Value);
+    usage.capacity += Capacity(c) * sizeof(Value);
+    if constexpr (!std::is_arithmetic_v<Value>) {
+        for (const Value& inner : c) {
+            Account(inner, usage);
+        }
+    }
+}
+
+// Смещения и значения плоской раскладки
+template <typename T>
+void Account(const JaggedVector<T>& c, Usage& usage) {
+    Account(c.Offsets(), usage);
+    Account(c.Values(), usage);
+}
+
+struct Footprint {
+    Usage usage;
+    int64_t heap_bytes = 0;
+    int64_t heap_free_bytes = 0;
+    int64_t rss_bytes = 0;
+    int64_t peak_rss_bytes = 0;
+    double seconds = 0;
+};
+
+struct MemorySnapshot {
+    int64_t heap_used = 0;
+    int64_t heap_free = 0;
+    int64_t rss = 0;
+};
+
+int64_t ReadStatusKb(const char* key) {
+    FILE* file = std::fopen("/proc/self/status", "r");
+    if (file == nullptr) {
+        return 0;
+    }
+    char line[256];
+    int64_t value = 0;
+    const size_t key_length = std::strlen(key);
+    while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (std::strncmp(line, key, key_length) == 0) {
+            value = std::strtoll(line + key_length, nullptr, 10);
+            break;
+        }
+    }
+    std::fclose(file);
+    return value * 1024;
+}
+
+MemorySnapshot TakeSnapshot() {
+    MemorySnapshot snapshot;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    // uordblks — занято в основной куче, hblkhd — крупные блоки через mmap
+    snapshot.heap_used = static_cast<int64_t>(info.uordblks + info.hblkhd);
+    snapshot.heap_free = static_cast<int64_t>(info.fordblks);
+#endif
+    snapshot.rss = ReadStatusKb("VmRSS:");
+    return snapshot;
+}
+
+template <typename Build>
+Footprint MeasureWorkload(Build build) {
+    // Сброс пика RSS; без прав остаётся пик с момента fork, он мал
+    if (FILE* refs = std::fopen("/proc/self/clear_refs", "w")) {
+        std::fputs("5", refs);
+        std::fclose(refs);
+    }
+    const MemorySnapshot before = TakeSnapshot();
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = build();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const MemorySnapshot after = TakeSnapshot();
+
+    Footprint footprint;
+    Account(result, footprint.usage);
+    footprint.heap_bytes = after.heap_used - before.heap_used;
+    footprint.heap_free_bytes = after.heap_free - before.heap_free;
+    footprint.rss_bytes = after.rss - before.rss;
+    footprint.peak_rss_bytes = ReadStatusKb("VmHWM:");
+    footprint.seconds = elapsed.count();
+    return footprint;
+}
+
+// Миллион мелких векторов длиной 0..16
+template <template <typename...> class Container>
+Footprint ManySmall(double scale, Growth growth) {
+    return MeasureWorkload([&] {
+        const size_t count = static_cast<size_t>(1'000'000 * scale);
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<uint32_t> length(0, 16);
+        Container<Container<uint32_t>> outer;
+        Reserve(outer, count);
+        for (size_t i = 0; i < count; ++i) {
+            Container<uint32_t> inner;
+            for (uint32_t j = length(rng); j > 0; --j) {
+                Push(inner, j, growth);
+            }
+            Finish(inner, growth);
+            Append(outer, std::move(inner));
+        }
+        return outer;
+    });
+}
+
+// Несколько огромных векторов, растущих поочерёдно
+template <template <typename...> class Container>
+Footprint FewHuge(double scale, Growth growth) {
+    return MeasureWorkload([&] {
+        const size_t count = 4;
+        const size_t length = static_cast<size_t>(4'000'000 * scale);
+        Container<Container<uint32_t>> outer;
+        Reserve(outer, count);
+        for (size_t i = 0; i < count; ++i) {
+            Append(outer, Container<uint32_t>());
+        }
+        for (size_t j = 0; j < length; ++j) {
+            for (auto& inner : outer) {
+                Push(inner, static_cast<uint32_t>(j), growth);
+            }
+        }
+        for (auto& inner : outer) {
+            Finish(inner, growth);
+        }
+        return outer;
+    });
+}
+
+// Случайные вставки и удаления с перевесом вставок: вместимость после пиков не возвращается
+template <template <typename...> class Container>
+Footprint Churn(double scale, Growth growth) {
+    return MeasureWorkload([&] {
+        const size_t count = 10'000;
+        const size_t operations = static_cast<size_t>(20'000'000 * scale);
+        std::mt19937 rng(2);
+        std::uniform_int_distribution<size_t> pick(0, count - 1);
+        std::uniform_int_distribution<int> action(0, 99);
+        Container<Container<uint64_t>> outer;
+        Reserve(outer, count);
+        for (size_t i = 0; i < count; ++i) {
+            Append(outer, Container<uint64_t>());
+        }
+        for (size_t op = 0; op < operations; ++op) {
+            auto& inner = *(outer.begin() + pick(rng));
+            if (action(rng) < 55 || Size(inner) == 0) {
+                Push(inner, static_cast<uint64_t>(op), growth);
+            } else {
+                PopBack(inner);
+            }
+        }
+        for (auto& inner : outer) {
+            Finish(inner, growth);
+        }
+        return outer;
+    });
+}
+
+// Списки смежности: рёбра добавляются вразнобой, степени вершин сильно перекошены
+template <typename Outer>
+Outer BuildAdjacency(double scale, Growth growth) {
+    const size_t nodes = static_cast<size_t>(200'000 * scale);
+    const size_t edges = nodes * 20;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    Outer outer;
+    Resize(outer, nodes);
+    for (size_t e = 0; e < edges; ++e) {
+        const double u = unit(rng);
+        const size_t from = static_cast<size_t>(u * u * u * static_cast<double>(nodes - 1));
+        Push(*(outer.begin() + from), static_cast<uint32_t>(rng() % nodes), growth);
+    }
+    for (auto& inner : outer) {
+        Finish(inner, growth);
+    }
+    return outer;
+}
+
+template <template <typename...> class Container>
+Footprint Adjacency(double scale, Growth growth) {
+    return MeasureWorkload([&] { return BuildAdjacency<Container<Container<uint32_t>>>(scale, growth); });
+}
+
+// Строки в арене: брошенные при росте буферы остаются в ней до освобождения
+Footprint AdjacencyArena(double scale, Growth growth) {
+    VectorArena arena;
+    return MeasureWorkload([&] {
+        VectorArenaScope scope(arena);
+        return BuildAdjacency<Vector<ArenaVector<uint32_t>>>(scale, growth);
+    });
+}
+
+// Строки в арене сжимаются Freeze, после чего арена освобождается целиком
+Footprint AdjacencyJagged(double scale, Growth growth) {
+    return MeasureWorkload([&] {
+        VectorArena arena;
+        VectorArenaScope scope(arena);
+        JaggedVector<uint32_t> jagged = Freeze(BuildAdjacency<Vector<ArenaVector<uint32_t>>>(scale, growth));
+        arena.Reset();
+        return jagged;
+    });
+}
+
+// Выполняет замер в дочернем процессе и возвращает результат через канал
+template <typename Run>
+bool RunIsolated(Run run, Footprint& footprint) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        const Footprint result = run();
+        const ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    const ssize_t received = read(fds[0], &footprint, sizeof(footprint));
+    close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return received == static_cast<ssize_t>(sizeof(footprint)) && WIFEXITED(status) &&
+           WEXITSTATUS(status) == 0;
+}
+
+double Mb(int64_t bytes) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void Report(std::string_view workload, std::string_view container, Growth growth, const Footprint& f) {
+    const int64_t payload = static_cast<int64_t>(f.usage.payload);
+    const int64_t capacity = static_cast<int64_t>(f.usage.capacity);
+    std::printf("%-10.*s %-12.*s %-10s %9.1f %9.1f %6.1f%% %9.1f %8.1f%% %9.1f %9.1f %9.1f %7.2f\n",
+                static_cast<int>(workload.size()), workload.data(), static_cast<int>(container.size()),
+                container.data(), GrowthName(growth), Mb(payload), Mb(capacity),
+                capacity != 0 ? 100.0 * static_cast<double>(capacity - payload) / static_cast<double>(capacity) : 0.0,
+                Mb(f.heap_bytes),
+                capacity != 0 ? 100.0 * static_cast<double>(f.heap_bytes - capacity) / static_cast<double>(capacity)
+                              : 0.0,
+                Mb(f.heap_free_bytes), Mb(f.rss_bytes), Mb(f.peak_rss_bytes), f.seconds);
+}
+
+using WorkloadFn = Footprint (*)(double, Growth);
+
+struct Workload {
+    const char* name;
+    WorkloadFn vector;
+    WorkloadFn std_vector;
+    WorkloadFn thin_vector;
+    WorkloadFn compact_vector;
+    WorkloadFn arena_vector = nullptr;
+    WorkloadFn jagged_vector = nullptr;
+};
+
+template <typename T>
+using StdVector = std::vector<T>;
+
+template <typename T>
+using CompactVector = Vector<T, uint32_t>;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const double scale = argc > 1 ? std::strtod(argv[1], nullptr) : 1.0;
+    const std::string_view only = argc > 2 ? argv[2] : "";
+    if (scale <= 0) {
+        std::fprintf(stderr, "usage: %s [scale] [workload]\n", argv[0]);
+        return 1;
+    }
+
+    const Workload WORKLOADS[] = {
+        {"small", ManySmall<Vector>, ManySmall<StdVector>, ManySmall<ThinVector>, ManySmall<CompactVector>},
+        {"huge", FewHuge<Vector>, FewHuge<StdVector>, FewHuge<ThinVector>, FewHuge<CompactVector>},
+        {"churn", Churn<Vector>, Churn<StdVector>, Churn<ThinVector>, Churn<CompactVector>},
+        {"adjacency", Adjacency<Vector>, Adjacency<StdVector>, Adjacency<ThinVector>, Adjacency<CompactVector>,
+         AdjacencyArena, AdjacencyJagged},
+    };
+    const Growth GROWTHS[] = {Growth::Native, Growth::Factor15, Growth::Shrink};
+
+    std::printf("scale: %g; sizes in MiB, overhead = heap over capacity, heap-free = free bytes left inside the heap\n",
+                scale);
+    std::printf("%-10s %-12s %-10s %9s %9s %7s %9s %9s %9s %9s %9s %7s\n", "workload", "container", "growth",
+                "payload", "capacity", "slack", "heap", "overhead", "heap-free", "rss", "peak-rss", "sec");
+    int failures = 0;
+    for (const Workload& workload : WORKLOADS) {
+        if (!only.empty() && only != workload.name) {
+            continue;
+        }
+        for (const Growth growth : GROWTHS) {
+            for (const auto& [container, fn] : {std::pair{"std::vector", workload.std_vector},
+                                                std::pair{"Vector", workload.vector},
+                                                std::pair{"Vector<u32>", workload.compact_vector},
+                                                std::pair{"ThinVector", workload.thin_vector},
+                                                std::pair{"ArenaVector", workload.arena_vector},
+                                                std::pair{"JaggedVector", workload.jagged_vector}}) {
+                if (fn == nullptr) {
+                    continue;
+                }
+                Footprint footprint;
+                if (RunIsolated([&] { return fn(scale, growth); }, footprint)) {
+                    Report(workload.name, container, growth, footprint);
+                } else {
+                    std::printf("%-10s %-12s %-10s failed\n", workload.name, container, GrowthName(growth));
+                    ++failures;
+                }
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
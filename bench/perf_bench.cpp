@@ -0,0 +1,186 @@
+// Сравнение Vector и std::vector по аппаратным счётчикам: на каждом ядре — время,
+// такты, инструкции, промахи кэшей и TLB, ошибки предсказания переходов на элемент.
+// Без доступа к perf_event_open (контейнер, perf_event_paranoid) печатается только время
+#include "container_ops.h"
+#include "perf_counters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using bench_ops::Append;
+using bench_ops::EraseAt;
+using bench_ops::InsertAt;
+using bench_ops::Reserve;
+using perf_bench::Counter;
+using perf_bench::PerfCounters;
+
+volatile uint64_t sink = 0;
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return "value #" + std::to_string(i);
+    } else {
+        return static_cast<T>(i * 2654435761u);
+    }
+}
+
+template <typename T>
+uint64_t Hash(const T& value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return value.size();
+    } else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+struct Sample {
+    double ns = 0;
+    double counters[perf_bench::COUNTER_COUNT] = {};
+};
+
+// Лучший по времени из нескольких прогонов. prepare() строит состояние вне замера,
+// run(state) замеряется, разрушение состояния тоже вне замера
+template <typename Prepare, typename Run>
+Sample Measure(PerfCounters& perf, Prepare prepare, Run run) {
+    using Clock = std::chrono::steady_clock;
+    const int REPEATS = 7;
+    Sample best;
+    best.ns = 1e300;
+    for (int r = 0; r < REPEATS; ++r) {
+        auto state = prepare();
+        perf.Start();
+        const auto start = Clock::now();
+        run(state);
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        perf.Stop();
+        if (elapsed.count() < best.ns) {
+            best.ns = elapsed.count();
+            for (size_t i = 0; i < perf_bench::COUNTER_COUNT; ++i) {
+                best.counters[i] = perf.Value(static_cast<Counter>(i));
+            }
+        }
+    }
+    return best;
+}
+
+void PrintHeader(const PerfCounters& perf) {
+    std::printf("%-14s %-11s %-12s %9s", "kernel", "type", "container", "ns/elem");
+    if (perf.AnyAvailable()) {
+        std::printf(" %6s", "IPC");
+        for (size_t i = 0; i < perf_bench::COUNTER_COUNT; ++i) {
+            std::printf(" %9s", perf_bench::CounterName(static_cast<Counter>(i)));
+        }
+    }
+    std::printf("\n");
+}
+
+void Report(const PerfCounters& perf, std::string_view kernel, std::string_view type, std::string_view container,
+            size_t elements, const Sample& sample) {
+    const double n = static_cast<double>(elements);
+    std::printf("%-14.*s %-11.*s %-12.*s %9.3f", static_cast<int>(kernel.size()), kernel.data(),
+                static_cast<int>(type.size()), type.data(), static_cast<int>(container.size()), container.data(),
+                sample.ns / n);
+    if (perf.AnyAvailable()) {
+        const double cycles = sample.counters[static_cast<size_t>(Counter::Cycles)];
+        const double instructions = sample.counters[static_cast<size_t>(Counter::Instructions)];
+        std::printf(" %6.2f", instructions / cycles);
+        for (const double value : sample.counters) {
+            // NaN печатается как nan: счётчик недоступен
+            std::printf(" %9.3f", value / n);
+        }
+    }
+    std::printf("\n");
+}
+
+template <typename Container, typename T>
+void RunKernels(PerfCounters& perf, std::string_view type, std::string_view container, size_t size,
+                size_t shift_size) {
+    std::vector<T> values;
+    values.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(MakeValue<T>(i));
+    }
+    const auto filled = [&](size_t n) {
+        return [&values, n] {
+            Container c;
+            Reserve(c, n);
+            for (size_t i = 0; i < n; ++i) {
+                Append(c, values[i]);
+            }
+            return c;
+        };
+    };
+    const auto empty = [] { return Container(); };
+
+    Report(perf, "append", type, container, size, Measure(perf, empty, [&](Container& c) {
+               for (size_t i = 0; i < size; ++i) {
+                   Append(c, values[i]);
+               }
+           }));
+    Report(perf, "reserve+append", type, container, size, Measure(perf, empty, [&](Container& c) {
+               Reserve(c, size);
+               for (size_t i = 0; i < size; ++i) {
+                   Append(c, values[i]);
+               }
+           }));
+    // Вставка и удаление в середине квадратичны, поэтому на меньшем размере
+    Report(perf, "insert-middle", type, container, shift_size, Measure(perf, empty, [&](Container& c) {
+               for (size_t i = 0; i < shift_size; ++i) {
+                   InsertAt(c, bench_ops::Size(c) / 2, values[i]);
+               }
+           }));
+    Report(perf, "erase-middle", type, container, shift_size, Measure(perf, filled(shift_size), [&](Container& c) {
+               for (size_t i = 0; i < shift_size; ++i) {
+                   EraseAt(c, bench_ops::Size(c) / 2);
+               }
+           }));
+    Report(perf, "copy", type, container, size, Measure(perf, filled(size), [&](Container& c) {
+               Container copy(c);
+               sink = sink + Hash(*copy.begin());
+           }));
+    Report(perf, "iterate", type, container, size, Measure(perf, filled(size), [&](Container& c) {
+               uint64_t sum = 0;
+               for (const T& value : c) {
+                   sum += Hash(value);
+               }
+               sink = sink + sum;
+           }));
+}
+
+template <typename T>
+void Run(PerfCounters& perf, std::string_view type, size_t size, size_t shift_size) {
+    RunKernels<std::vector<T>, T>(perf, type, "std::vector", size, shift_size);
+    RunKernels<Vector<T>, T>(perf, type, "Vector", size, shift_size);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1u << 20);
+    const size_t shift_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : (1u << 14);
+    if (size == 0 || shift_size == 0 || shift_size > size) {
+        std::fprintf(stderr, "usage: %s [elements] [insert/erase elements <= elements]\n", argv[0]);
+        return 1;
+    }
+
+    PerfCounters perf;
+    if (!perf.AnyAvailable()) {
+        std::printf("hardware counters unavailable (%s), reporting wall clock only\n", perf.Error().c_str());
+    } else if (!perf.Error().empty()) {
+        std::printf("some hardware counters unavailable (%s), shown as nan\n", perf.Error().c_str());
+    }
+    std::printf("elements: %zu, insert/erase elements: %zu, counters per element\n", size, shift_size);
+    PrintHeader(perf);
+    Run<uint64_t>(perf, "uint64_t", size, shift_size);
+    Run<std::string>(perf, "std::string", size, shift_size);
+}
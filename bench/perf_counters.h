@@ -0,0 +1,146 @@
+// Аппаратные счётчики через perf_event_open для замеров вокруг отдельных ядер бенчмарков
+#pragma once
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace perf_bench {
+
+enum class Counter {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    DtlbMisses,
+    BranchMisses,
+};
+
+inline constexpr size_t COUNTER_COUNT = 6;
+
+inline const char* CounterName(Counter counter) {
+    static const char* const NAMES[COUNTER_COUNT] = {"cycles", "instr", "L1d-miss", "LLC-miss", "dTLB-miss",
+                                                     "br-miss"};
+    return NAMES[static_cast<size_t>(counter)];
+}
+
+// Каждый счётчик открывается отдельно, а не группой: в контейнерах и виртуальных машинах
+// часть событий обычно недоступна, и группа не открылась бы целиком. Недоступный счётчик
+// даёт NaN, остальные работают. При нехватке регистров ядро мультиплексирует счётчики,
+// значения масштабируются по доле времени, когда счётчик действительно считал
+class PerfCounters {
+public:
+    PerfCounters() {
+        const auto cache_miss = [](uint64_t cache) {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        };
+        const std::pair<uint32_t, uint64_t> EVENTS[COUNTER_COUNT] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+            {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            fds_[i] = Open(EVENTS[i].first, EVENTS[i].second);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters() {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    bool Available(Counter counter) const noexcept {
+        return fds_[static_cast<size_t>(counter)] >= 0;
+    }
+
+    bool AnyAvailable() const noexcept {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Причина, по которой не открылся первый недоступный счётчик
+    const std::string& Error() const noexcept {
+        return error_;
+    }
+
+    void Start() noexcept {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    void Stop() noexcept {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            values_[i] = Read(fds_[i]);
+        }
+    }
+
+    // Значение за последний интервал Start/Stop или NaN
+    double Value(Counter counter) const noexcept {
+        return values_[static_cast<size_t>(counter)];
+    }
+
+private:
+    int Open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0 && error_.empty()) {
+            error_ = std::strerror(errno);
+        }
+        return fd;
+    }
+
+    static double Read(int fd) noexcept {
+        if (fd < 0) {
+            return NAN;
+        }
+        uint64_t data[3] = {};
+        if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0) {
+            return NAN;
+        }
+        return static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+    }
+
+    int fds_[COUNTER_COUNT] = {-1, -1, -1, -1, -1, -1};
+    double values_[COUNTER_COUNT] = {NAN, NAN, NAN, NAN, NAN, NAN};
+    std::string error_;
+};
+
+}  // namespace perf_bench
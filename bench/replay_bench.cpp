@@ -0,0 +1,410 @@
+// Воспроизведение трассы операций над Vector (см. vector_record.h) на Vector, std::vector
+// и GapVector. Трасса пишется приложением, собранным с VECTOR_ENABLE_RECORDING:
+//
+//     vector_record::Start("service.vtrace");
+//     ...
+//     vector_record::Stop();
+//
+// и затем воспроизводится: vec_replay_bench service.vtrace. Без аргументов бенчмарк
+// строит синтетическую трассу с похожей смесью операций.
+//
+// Значения элементов в трассе не хранятся, поэтому элементы заменяются тривиально
+// копируемыми блоками того же размера (округлённого до степени двойки, не больше 256 байт).
+// Операции, которые не согласуются с восстановленным размером вектора (например, над
+// памятью, изменённой в обход Vector), пропускаются и подсчитываются
+#include "container_ops.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using namespace bench_ops;
+using vector_record::Event;
+using vector_record::Op;
+
+inline constexpr size_t BUCKET_COUNT = 9;
+
+template <size_t Bytes>
+struct Blob {
+    unsigned char bytes[Bytes];
+};
+
+size_t Bucket(uint64_t element_size) {
+    size_t bucket = 0;
+    while (bucket + 1 < BUCKET_COUNT && (uint64_t{1} << bucket) < element_size) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+// Операция над плотными номерами экземпляров
+struct Step {
+    Op op;
+    uint32_t id;
+    uint32_t other;
+    uint64_t a;
+    uint64_t b;
+};
+
+struct Trace {
+    std::vector<Step> steps;
+    std::vector<uint8_t> buckets;
+    std::array<uint64_t, static_cast<size_t>(Op::Count)> counts = {};
+};
+
+// Переводит номера из трассы в плотные и запоминает размер элемента каждого экземпляра
+class TraceBuilder {
+public:
+    void Add(const Event& event) {
+        ++trace_.counts[static_cast<size_t>(event.op)];
+        Step step{event.op, 0, 0, 0, 0};
+        switch (event.op) {
+            case Op::Adopt:
+                step.id = Create(event.args[0], Bucket(event.args[1]));
+                step.a = event.args[2];
+                step.b = event.args[3];
+                break;
+            case Op::CopyConstruct:
+            case Op::MoveConstruct:
+                step.other = Find(event.args[1]);
+                step.id = Create(event.args[0], trace_.buckets[step.other]);
+                break;
+            case Op::CopyAssign:
+            case Op::MoveAssign:
+            case Op::Swap:
+                step.id = Find(event.args[0]);
+                step.other = Find(event.args[1]);
+                break;
+            case Op::Destroy:
+                step.id = Find(event.args[0]);
+                ids_.erase(event.args[0]);
+                break;
+            default:
+                step.id = Find(event.args[0]);
+                step.a = event.args[1];
+                step.b = event.args[2];
+                break;
+        }
+        trace_.steps.push_back(step);
+    }
+
+    Trace Take() {
+        return std::move(trace_);
+    }
+
+private:
+    uint32_t Create(uint64_t raw_id, size_t bucket) {
+        const auto id = static_cast<uint32_t>(trace_.buckets.size());
+        trace_.buckets.push_back(static_cast<uint8_t>(bucket));
+        ids_[raw_id] = id;
+        return id;
+    }
+
+    uint32_t Find(uint64_t raw_id) const {
+        const auto it = ids_.find(raw_id);
+        if (it == ids_.end()) {
+            throw std::runtime_error("trace refers to an unknown vector");
+        }
+        return it->second;
+    }
+
+    Trace trace_;
+    std::unordered_map<uint64_t, uint32_t> ids_;
+};
+
+Trace LoadTrace(const char* path) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        throw std::runtime_error(std::string("cannot open ") + path);
+    }
+    TraceBuilder builder;
+    try {
+        vector_record::ReadTrace(file, [&](const Event& event) { builder.Add(event); });
+    } catch (...) {
+        std::fclose(file);
+        throw;
+    }
+    std::fclose(file);
+    return builder.Take();
+}
+
+// Смесь операций небольшого сервиса: много коротких векторов, добавление в конец,
+// изредка вставка и удаление в середине, копирование, перемещение, резервирование
+Trace SyntheticTrace(size_t operations) {
+    std::mt19937_64 rng(42);
+    TraceBuilder builder;
+    struct Live {
+        uint64_t id;
+        uint64_t size;
+    };
+    std::vector<Live> live;
+    uint64_t next_id = 1;
+    const uint64_t SIZES[] = {4, 8, 16, 24, 64};
+    const auto emit = [&](Op op, uint64_t a0, uint64_t a1 = 0, uint64_t a2 = 0, uint64_t a3 = 0) {
+        Event event;
+        event.op = op;
+        event.args[0] = a0;
+        event.args[1] = a1;
+        event.args[2] = a2;
+        event.args[3] = a3;
+        builder.Add(event);
+    };
+    for (size_t i = 0; i < operations; ++i) {
+        const uint64_t roll = rng() % 1000;
+        if (live.size() < 64 || roll < 20) {
+            live.push_back({next_id, 0});
+            emit(Op::Adopt, next_id++, SIZES[rng() % std::size(SIZES)], 0, 0);
+            continue;
+        }
+        Live& v = live[rng() % live.size()];
+        if (roll < 700) {
+            emit(Op::EmplaceBack, v.id);
+            ++v.size;
+        } else if (roll < 760 && v.size > 0) {
+            emit(Op::Emplace, v.id, rng() % (v.size + 1));
+            ++v.size;
+        } else if (roll < 820 && v.size > 0) {
+            emit(Op::Erase, v.id, rng() % v.size, 1);
+            --v.size;
+        } else if (roll < 900 && v.size > 0) {
+            emit(Op::PopBack, v.id);
+            --v.size;
+        } else if (roll < 920) {
+            emit(Op::Reserve, v.id, v.size + rng() % 64);
+        } else if (roll < 940) {
+            v.size = rng() % 32;
+            emit(Op::Resize, v.id, v.size);
+        } else if (roll < 960) {
+            const uint64_t src = v.id;
+            const uint64_t size = v.size;
+            live.push_back({next_id, size});
+            emit(Op::CopyConstruct, next_id++, src);
+        } else if (roll < 975) {
+            const uint64_t src = v.id;
+            const uint64_t size = v.size;
+            v.size = 0;
+            live.push_back({next_id, size});
+            emit(Op::MoveConstruct, next_id++, src);
+        } else {
+            const size_t index = static_cast<size_t>(&v - live.data());
+            emit(Op::Destroy, v.id);
+            live[index] = live.back();
+            live.pop_back();
+        }
+    }
+    for (const Live& v : live) {
+        emit(Op::Destroy, v.id);
+    }
+    return builder.Take();
+}
+
+// Контейнеры одного семейства для всех размеров элементов
+template <template <typename> class Container>
+class Replayer {
+public:
+    explicit Replayer(const Trace& trace) : trace_(trace) {
+    }
+
+    // Выполняет трассу и разрушает оставшиеся экземпляры; возвращает число пропущенных операций
+    uint64_t Run() {
+        skipped_ = 0;
+        Prepare(std::make_index_sequence<BUCKET_COUNT>());
+        for (const Step& step : trace_.steps) {
+            DISPATCH[trace_.buckets[step.id]](*this, step);
+        }
+        Clear(std::make_index_sequence<BUCKET_COUNT>());
+        return skipped_;
+    }
+
+private:
+    template <size_t Bucket>
+    using Value = Blob<size_t{1} << Bucket>;
+
+    template <size_t Bucket>
+    using Slots = std::vector<std::optional<Container<Value<Bucket>>>>;
+
+    template <size_t... Buckets>
+    void Prepare(std::index_sequence<Buckets...>) {
+        (std::get<Buckets>(slots_).assign(trace_.buckets.size(), std::nullopt), ...);
+    }
+
+    template <size_t... Buckets>
+    void Clear(std::index_sequence<Buckets...>) {
+        (std::get<Buckets>(slots_).clear(), ...);
+    }
+
+    template <size_t Bucket>
+    static void Apply(Replayer& self, const Step& step) {
+        Slots<Bucket>& slots = std::get<Bucket>(self.slots_);
+        auto& slot = slots[step.id];
+        if (step.op != Op::Adopt && step.op != Op::CopyConstruct && step.op != Op::MoveConstruct && !slot) {
+            ++self.skipped_;
+            return;
+        }
+        const Value<Bucket> value{};
+        switch (step.op) {
+            case Op::Adopt:
+                slot.emplace();
+                Reserve(*slot, step.b);
+                Resize(*slot, step.a);
+                break;
+            case Op::Destroy:
+                slot.reset();
+                break;
+            case Op::EmplaceBack:
+                Append(*slot, value);
+                break;
+            case Op::Emplace:
+                if (step.a > Size(*slot)) {
+                    ++self.skipped_;
+                    break;
+                }
+                InsertAt(*slot, step.a, value);
+                break;
+            case Op::Erase:
+                if (step.a + step.b > Size(*slot)) {
+                    ++self.skipped_;
+                    break;
+                }
+                if (step.b == 1) {
+                    EraseAt(*slot, step.a);
+                } else if (step.b != 0) {
+                    EraseRange(*slot, step.a, step.b);
+                }
+                break;
+            case Op::EraseUnordered:
+                if (step.a >= Size(*slot)) {
+                    ++self.skipped_;
+                    break;
+                }
+                EraseUnorderedAt(*slot, step.a);
+                break;
+            case Op::PopBack:
+                if (Size(*slot) == 0) {
+                    ++self.skipped_;
+                    break;
+                }
+                PopBack(*slot);
+                break;
+            case Op::Reserve:
+                Reserve(*slot, step.a);
+                break;
+            case Op::Resize:
+                Resize(*slot, step.a);
+                break;
+            case Op::CopyConstruct:
+            case Op::MoveConstruct: {
+                auto& source = slots[step.other];
+                if (!source) {
+                    ++self.skipped_;
+                    break;
+                }
+                if (step.op == Op::CopyConstruct) {
+                    slot.emplace(*source);
+                } else {
+                    slot.emplace(std::move(*source));
+                }
+                break;
+            }
+            case Op::CopyAssign:
+            case Op::MoveAssign:
+            case Op::Swap: {
+                auto& other = slots[step.other];
+                if (!other) {
+                    ++self.skipped_;
+                } else if (step.op == Op::CopyAssign) {
+                    *slot = *other;
+                } else if (step.op == Op::MoveAssign) {
+                    *slot = std::move(*other);
+                } else {
+                    Swap(*slot, *other);
+                }
+                break;
+            }
+            case Op::Count:
+                break;
+        }
+    }
+
+    using ApplyFn = void (*)(Replayer&, const Step&);
+
+    template <size_t... Buckets>
+    static constexpr std::array<ApplyFn, BUCKET_COUNT> MakeDispatch(std::index_sequence<Buckets...>) {
+        return {&Apply<Buckets>...};
+    }
+
+    static constexpr std::array<ApplyFn, BUCKET_COUNT> DISPATCH =
+        MakeDispatch(std::make_index_sequence<BUCKET_COUNT>());
+
+    template <size_t... Buckets>
+    static auto MakeSlots(std::index_sequence<Buckets...>) -> std::tuple<Slots<Buckets>...>;
+
+    const Trace& trace_;
+    decltype(MakeSlots(std::make_index_sequence<BUCKET_COUNT>())) slots_;
+    uint64_t skipped_ = 0;
+};
+
+template <typename T>
+using StdVector = std::vector<T>;
+
+template <template <typename> class Container>
+void Measure(std::string_view name, const Trace& trace) {
+    using Clock = std::chrono::steady_clock;
+    const int REPEATS = 5;
+    Replayer<Container> replayer(trace);
+    double best = 1e300;
+    uint64_t skipped = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+        const auto start = Clock::now();
+        skipped = replayer.Run();
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    std::printf("%-12.*s %10.3f ms %8.2f ns/op  skipped: %llu\n", static_cast<int>(name.size()), name.data(),
+                best / 1e6, best / static_cast<double>(trace.steps.size()),
+                static_cast<unsigned long long>(skipped));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Trace trace;
+    try {
+        if (argc > 1) {
+            trace = LoadTrace(argv[1]);
+            std::printf("trace: %s\n", argv[1]);
+        } else {
+            trace = SyntheticTrace(2'000'000);
+            std::printf("trace: synthetic (pass a file written by vector_record to replay it)\n");
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+
+    std::printf("operations: %zu, vectors: %zu\n", trace.steps.size(), trace.buckets.size());
+    for (size_t op = 0; op < trace.counts.size(); ++op) {
+        if (trace.counts[op] != 0) {
+            std::printf("  %-15s %llu\n", vector_record::OpName(static_cast<Op>(op)),
+                        static_cast<unsigned long long>(trace.counts[op]));
+        }
+    }
+    Measure<StdVector>("std::vector", trace);
+    Measure<Vector>("Vector", trace);
+    Measure<GapVector>("GapVector", trace);
+}
@@ -0,0 +1,89 @@
+// Сравнение векторизованных Find/Count/Sum/MinMax/ArgMin с алгоритмами стандартной библиотеки
+#include "vector_simd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <string_view>
+
+namespace {
+
+volatile uint64_t sink = 0;
+
+template <typename Value>
+void Consume(const Value& value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, std::min(sizeof(bits), sizeof(value)));
+    sink = sink + bits;
+}
+
+// Лучшее время одного прогона fn в наносекундах на элемент
+template <typename Fn>
+double Measure(size_t size, Fn fn) {
+    using Clock = std::chrono::steady_clock;
+    const int REPEATS = 20;
+    double best = 1e300;
+    for (int r = 0; r < REPEATS; ++r) {
+        const auto start = Clock::now();
+        fn();
+        const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(size));
+    }
+    return best;
+}
+
+void Report(std::string_view op, std::string_view type, double std_ns, double vec_ns) {
+    std::printf("%-8.*s %-9.*s std: %7.3f ns/elem  Vector: %7.3f ns/elem  speedup: %5.2fx\n",
+                static_cast<int>(op.size()), op.data(), static_cast<int>(type.size()), type.data(),
+                std_ns, vec_ns, std_ns / vec_ns);
+}
+
+template <typename T>
+void Run(std::string_view type, size_t size) {
+    Vector<T> v(size);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        v[i] = static_cast<T>((seed >> 16) % 1000 + 1);
+    }
+    // Искомое значение в самом конце: поиск проходит весь массив
+    const T needle = 0;
+    v[size - 1] = needle;
+
+    Report("Find", type,
+           Measure(size, [&] { Consume(std::find(v.begin(), v.end(), needle) - v.begin()); }),
+           Measure(size, [&] { Consume(Find(v, needle) - v.begin()); }));
+    Report("Count", type,
+           Measure(size, [&] { Consume(std::count(v.begin(), v.end(), needle)); }),
+           Measure(size, [&] { Consume(Count(v, needle)); }));
+    Report("Sum", type,
+           Measure(size, [&] { Consume(std::accumulate(v.begin(), v.end(), vector_simd::SumType<T>{})); }),
+           Measure(size, [&] { Consume(Sum(v)); }));
+    Report("MinMax", type,
+           Measure(size, [&] {
+               const auto [min, max] = std::minmax_element(v.begin(), v.end());
+               Consume(*min);
+               Consume(*max);
+           }),
+           Measure(size, [&] {
+               const auto [min, max] = MinMax(v);
+               Consume(min);
+               Consume(max);
+           }));
+    Report("ArgMin", type,
+           Measure(size, [&] { Consume(std::min_element(v.begin(), v.end()) - v.begin()); }),
+           Measure(size, [&] { Consume(ArgMin(v)); }));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : (1u << 20);
+    std::printf("elements: %zu\n", size);
+    Run<int32_t>("int32_t", size);
+    Run<float>("float", size);
+    Run<uint64_t>("uint64_t", size);
+    Run<double>("double", size);
+}
@@ -0,0 +1,446 @@
+#pragma once
+#include "vector.h"
+#include "vector_simd.h"
+
+#include <cstdint>
+
+// Упакованный битовый вектор: бит на значение вместо байта у Vector<bool>.
+// Биты хранятся в 64-битных словах RawMemory<uint64_t>, бит i — в слове i / 64.
+// Биты последнего слова за пределами Size() всегда нулевые, поэтому Count
+// и поэлементные операции работают по целым словам без масок.
+namespace bit_vector
+{
+    inline constexpr size_t kWordBits = 64;
+
+    inline size_t WordCount(size_t bits) noexcept
+    {
+        return (bits + kWordBits - 1) / kWordBits;
+    }
+
+    // Маска значащих битов последнего слова; для кратного 64 размера — всё слово
+    inline uint64_t TailMask(size_t bits) noexcept
+    {
+        const size_t tail = bits % kWordBits;
+        return tail == 0 ? ~uint64_t{0} : (uint64_t{1} << tail) - 1;
+    }
+
+    VECTOR_SIMD_CLONES inline size_t CountKernel(const uint64_t *words, size_t n) noexcept
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            count += static_cast<size_t>(__builtin_popcountll(words[i]));
+        }
+        return count;
+    }
+
+    VECTOR_SIMD_CLONES inline void AndKernel(uint64_t *dst, const uint64_t *src, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            dst[i] &= src[i];
+        }
+    }
+
+    VECTOR_SIMD_CLONES inline void OrKernel(uint64_t *dst, const uint64_t *src, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            dst[i] |= src[i];
+        }
+    }
+
+    VECTOR_SIMD_CLONES inline void XorKernel(uint64_t *dst, const uint64_t *src, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            dst[i] ^= src[i];
+        }
+    }
+
+    VECTOR_SIMD_CLONES inline void AndNotKernel(uint64_t *dst, const uint64_t *src, size_t n) noexcept
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            dst[i] &= ~src[i];
+        }
+    }
+
+    // Позиция k-го (с нуля) единичного бита слова; k < popcount(word)
+    inline size_t SelectInWord(uint64_t word, size_t k) noexcept
+    {
+        for (; k != 0; --k)
+        {
+            word &= word - 1;
+        }
+        return static_cast<size_t>(__builtin_ctzll(word));
+    }
+
+} // namespace bit_vector
+
+class BitVector
+{
+public:
+    BitVector() = default;
+
+    explicit BitVector(size_t size, bool value = false)
+        : words_(bit_vector::WordCount(size)), size_(size)
+    {
+        std::fill_n(words_.GetAddress(), words_.Capacity(), value ? ~uint64_t{0} : 0);
+        ClearTail();
+    }
+
+    BitVector(const BitVector &other)
+        : words_(bit_vector::WordCount(other.size_)), size_(other.size_)
+    {
+        std::copy_n(other.words_.GetAddress(), WordCount(), words_.GetAddress());
+    }
+
+    BitVector(BitVector &&other) noexcept
+        : words_(std::move(other.words_)), size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    BitVector &operator=(const BitVector &rhs)
+    {
+        if (this != &rhs)
+        {
+            if (rhs.size_ > Capacity())
+            {
+                BitVector rhs_copy(rhs);
+                Swap(rhs_copy);
+            }
+            else
+            {
+                std::copy_n(rhs.words_.GetAddress(), rhs.WordCount(), words_.GetAddress());
+                size_ = rhs.size_;
+            }
+        }
+        return *this;
+    }
+
+    BitVector &operator=(BitVector &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            words_ = std::move(rhs.words_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    // Ёмкость в битах
+    size_t Capacity() const noexcept
+    {
+        return words_.Capacity() * bit_vector::kWordBits;
+    }
+
+    size_t WordCount() const noexcept
+    {
+        return bit_vector::WordCount(size_);
+    }
+
+    // Слова с битами; биты последнего слова за пределами Size() нулевые
+    const uint64_t *Words() const noexcept
+    {
+        return words_.GetAddress();
+    }
+
+    bool Test(size_t index) const noexcept
+    {
+        assert(index < size_);
+        return (words_[index / bit_vector::kWordBits] >> (index % bit_vector::kWordBits)) & 1;
+    }
+
+    bool operator[](size_t index) const noexcept
+    {
+        return Test(index);
+    }
+
+    void Set(size_t index, bool value = true) noexcept
+    {
+        assert(index < size_);
+        uint64_t &word = words_[index / bit_vector::kWordBits];
+        const uint64_t bit = uint64_t{1} << (index % bit_vector::kWordBits);
+        // Без ветвления: сбрасываем бит и записываем нужное значение
+        word = (word & ~bit) | (-static_cast<uint64_t>(value) & bit);
+    }
+
+    void Reset(size_t index) noexcept
+    {
+        Set(index, false);
+    }
+
+    void Flip(size_t index) noexcept
+    {
+        assert(index < size_);
+        words_[index / bit_vector::kWordBits] ^= uint64_t{1} << (index % bit_vector::kWordBits);
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        RawMemory<uint64_t> new_words(bit_vector::WordCount(new_capacity));
+        std::copy_n(words_.GetAddress(), WordCount(), new_words.GetAddress());
+        words_.Swap(new_words);
+    }
+
+    void Resize(size_t new_size, bool value = false)
+    {
+        if (new_size > size_)
+        {
+            Reserve(new_size);
+            const size_t old_words = WordCount();
+            const size_t new_words = bit_vector::WordCount(new_size);
+            if (value && old_words != 0)
+            {
+                // Хвост последнего слова нулевой, достаточно дописать единицы выше size_
+                words_[old_words - 1] |= ~bit_vector::TailMask(size_);
+            }
+            std::fill(words_ + old_words, words_ + new_words, value ? ~uint64_t{0} : 0);
+        }
+        size_ = new_size;
+        ClearTail();
+    }
+
+    void PushBack(bool value)
+    {
+        if (size_ == Capacity())
+        {
+            Reserve(size_ == 0 ? bit_vector::kWordBits : 2 * size_);
+        }
+        const size_t word = size_ / bit_vector::kWordBits;
+        const size_t bit = size_ % bit_vector::kWordBits;
+        // Новое слово ещё не инициализировано — первый бит слова перезаписывает его целиком
+        const uint64_t kept = bit == 0 ? 0 : words_[word];
+        words_[word] = kept | (static_cast<uint64_t>(value) << bit);
+        ++size_;
+    }
+
+    void PopBack() noexcept
+    {
+        assert(size_ != 0);
+        --size_;
+        ClearTail();
+    }
+
+    // Число единичных битов
+    size_t Count() const noexcept
+    {
+        return bit_vector::CountKernel(words_.GetAddress(), WordCount());
+    }
+
+    bool Any() const noexcept
+    {
+        const uint64_t *words = words_.GetAddress();
+        return std::any_of(words, words + WordCount(), [](uint64_t word) {
+            return word != 0;
+        });
+    }
+
+    // Вызывает fn(index) для каждого единичного бита по возрастанию
+    template <typename F>
+    void ForEachSetBit(F &&fn) const
+    {
+        for (size_t w = 0; w < WordCount(); ++w)
+        {
+            for (uint64_t word = words_[w]; word != 0; word &= word - 1)
+            {
+                fn(w * bit_vector::kWordBits + static_cast<size_t>(__builtin_ctzll(word)));
+            }
+        }
+    }
+
+    // Поэлементные операции над векторами одинакового размера
+    BitVector &operator&=(const BitVector &rhs) noexcept
+    {
+        assert(size_ == rhs.size_);
+        bit_vector::AndKernel(words_.GetAddress(), rhs.words_.GetAddress(), WordCount());
+        return *this;
+    }
+
+    BitVector &operator|=(const BitVector &rhs) noexcept
+    {
+        assert(size_ == rhs.size_);
+        bit_vector::OrKernel(words_.GetAddress(), rhs.words_.GetAddress(), WordCount());
+        return *this;
+    }
+
+    BitVector &operator^=(const BitVector &rhs) noexcept
+    {
+        assert(size_ == rhs.size_);
+        bit_vector::XorKernel(words_.GetAddress(), rhs.words_.GetAddress(), WordCount());
+        return *this;
+    }
+
+    // this &= ~rhs
+    BitVector &AndNot(const BitVector &rhs) noexcept
+    {
+        assert(size_ == rhs.size_);
+        bit_vector::AndNotKernel(words_.GetAddress(), rhs.words_.GetAddress(), WordCount());
+        return *this;
+    }
+
+    bool operator==(const BitVector &rhs) const noexcept
+    {
+        return size_ == rhs.size_ && std::equal(Words(), Words() + WordCount(), rhs.Words());
+    }
+
+    bool operator!=(const BitVector &rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+
+    void Swap(BitVector &other) noexcept
+    {
+        words_.Swap(other.words_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    void ClearTail() noexcept
+    {
+        if (size_ % bit_vector::kWordBits != 0)
+        {
+            words_[WordCount() - 1] &= bit_vector::TailMask(size_);
+        }
+    }
+
+    RawMemory<uint64_t> words_;
+    size_t size_ = 0;
+};
+
+inline BitVector operator&(BitVector lhs, const BitVector &rhs) noexcept
+{
+    lhs &= rhs;
+    return lhs;
+}
+
+inline BitVector operator|(BitVector lhs, const BitVector &rhs) noexcept
+{
+    lhs |= rhs;
+    return lhs;
+}
+
+inline BitVector operator^(BitVector lhs, const BitVector &rhs) noexcept
+{
+    lhs ^= rhs;
+    return lhs;
+}
+
+// Индекс для Rank и Select за O(1) и O(log n) поверх неизменяемого BitVector.
+// Хранит абсолютный счётчик единиц на каждые 4096 бит и 16-битный относительный
+// на каждые 512 бит — около 5% к размеру вектора. После изменения вектора индекс
+// нужно построить заново; вектор должен жить дольше индекса
+class BitVectorRank
+{
+    static constexpr size_t kWordsPerBlock = 8;
+    static constexpr size_t kBlocksPerSuper = 8;
+    static constexpr size_t kWordsPerSuper = kWordsPerBlock * kBlocksPerSuper;
+
+public:
+    explicit BitVectorRank(const BitVector &bits)
+        : bits_(&bits)
+    {
+        const size_t words = bits.WordCount();
+        const size_t blocks = (words + kWordsPerBlock - 1) / kWordsPerBlock;
+        supers_.Reserve(blocks / kBlocksPerSuper + 2);
+        blocks_.Reserve(blocks);
+
+        uint64_t total = 0;
+        uint16_t in_super = 0;
+        for (size_t block = 0; block < blocks; ++block)
+        {
+            if (block % kBlocksPerSuper == 0)
+            {
+                supers_.PushBack(total);
+                in_super = 0;
+            }
+            blocks_.PushBack(in_super);
+            const size_t first = block * kWordsPerBlock;
+            const size_t count = bit_vector::CountKernel(bits.Words() + first, std::min(kWordsPerBlock, words - first));
+            total += count;
+            in_super = static_cast<uint16_t>(in_super + count);
+        }
+        // Замыкающий счётчик — общее число единиц, граница для двоичного поиска в Select
+        supers_.PushBack(total);
+    }
+
+    // Число единиц на позициях [0, index)
+    size_t Rank(size_t index) const noexcept
+    {
+        assert(index <= bits_->Size());
+        const size_t word = index / bit_vector::kWordBits;
+        const size_t block = word / kWordsPerBlock;
+        if (block == blocks_.Size())
+        {
+            // index == Size() на границе блока
+            return static_cast<size_t>(supers_[supers_.Size() - 1]);
+        }
+        size_t rank = static_cast<size_t>(supers_[block / kBlocksPerSuper]) + blocks_[block];
+        const uint64_t *words = bits_->Words();
+        for (size_t w = block * kWordsPerBlock; w < word; ++w)
+        {
+            rank += static_cast<size_t>(__builtin_popcountll(words[w]));
+        }
+        const size_t bit = index % bit_vector::kWordBits;
+        if (bit != 0)
+        {
+            rank += static_cast<size_t>(__builtin_popcountll(words[word] & ((uint64_t{1} << bit) - 1)));
+        }
+        return rank;
+    }
+
+    // Позиция единицы с номером k (с нуля); Size() вектора, если единиц не больше k
+    size_t Select(size_t k) const noexcept
+    {
+        if (k >= Ones())
+        {
+            return bits_->Size();
+        }
+        // Последний суперблок, в начале которого единиц не больше k
+        const uint64_t *supers = supers_.begin();
+        const size_t super = static_cast<size_t>(std::upper_bound(supers, supers + supers_.Size() - 1, k) - supers) - 1;
+        k -= static_cast<size_t>(supers[super]);
+
+        size_t block = super * kBlocksPerSuper;
+        const size_t block_end = std::min(block + kBlocksPerSuper, blocks_.Size());
+        while (block + 1 < block_end && blocks_[block + 1] <= k)
+        {
+            ++block;
+        }
+        k -= blocks_[block];
+
+        const uint64_t *words = bits_->Words();
+        size_t word = block * kWordsPerBlock;
+        for (;; ++word)
+        {
+            const size_t count = static_cast<size_t>(__builtin_popcountll(words[word]));
+            if (k < count)
+            {
+                break;
+            }
+            k -= count;
+        }
+        return word * bit_vector::kWordBits + bit_vector::SelectInWord(words[word], k);
+    }
+
+    // Общее число единиц
+    size_t Ones() const noexcept
+    {
+        return static_cast<size_t>(supers_[supers_.Size() - 1]);
+    }
+
+private:
+    const BitVector *bits_;
+    Vector<uint64_t> supers_;
+    Vector<uint16_t> blocks_;
+};
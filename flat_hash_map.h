@@ -0,0 +1,583 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Хеш-таблица с открытой адресацией в духе SwissTable.
+// Пары ключ–значение лежат в RawMemory без узлов, а рядом — массив управляющих байтов:
+// у занятой ячейки в нём 7 младших битов хеша, у свободной — kEmpty, у удалённой — kDeleted.
+// Байты разбиты на выровненные группы по 16; поиск сравнивает всю группу с 7 битами
+// хеша одной SSE2-инструкцией и заглядывает в ячейки только при совпадении,
+// так что на одну пробу приходится одно обращение к паре.
+namespace flat_hash
+{
+    inline constexpr size_t kGroupWidth = 16;
+
+    inline constexpr int8_t kEmpty = -128;  // 0b10000000
+    inline constexpr int8_t kDeleted = -2;  // 0b11111110
+
+    // Доля заполнения, после которой таблица растёт: 7/8
+    inline size_t MaxLoad(size_t capacity) noexcept
+    {
+        return capacity - capacity / 8;
+    }
+
+    // Перемешивает хеш: std::hash для целых — тождественная функция,
+    // а таблице нужны равномерные и младшие, и старшие биты
+    inline uint64_t Mix(uint64_t hash) noexcept
+    {
+        const __uint128_t product = static_cast<__uint128_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+    }
+
+    // Набор позиций в группе, бит i — байт i
+    class BitMask
+    {
+    public:
+        explicit BitMask(uint32_t mask) noexcept
+            : mask_(mask)
+        {
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return mask_ != 0;
+        }
+
+        size_t Lowest() const noexcept
+        {
+            return static_cast<size_t>(__builtin_ctz(mask_));
+        }
+
+        // Снимает младшую позицию
+        void Next() noexcept
+        {
+            mask_ &= mask_ - 1;
+        }
+
+    private:
+        uint32_t mask_;
+    };
+
+    class Group
+    {
+    public:
+        // ctrl выровнен на kGroupWidth
+        explicit Group(const int8_t *ctrl) noexcept
+#if defined(__SSE2__)
+            : ctrl_(_mm_load_si128(reinterpret_cast<const __m128i *>(ctrl)))
+#else
+            : ctrl_(ctrl)
+#endif
+        {
+        }
+
+        BitMask Match(int8_t h2) const noexcept
+        {
+#if defined(__SSE2__)
+            return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_, _mm_set1_epi8(h2)))));
+#else
+            return Scan([h2](int8_t c) {
+                return c == h2;
+            });
+#endif
+        }
+
+        BitMask MatchEmpty() const noexcept
+        {
+            return Match(kEmpty);
+        }
+
+        // Свободные и удалённые — у обоих установлен старший бит
+        BitMask MatchEmptyOrDeleted() const noexcept
+        {
+#if defined(__SSE2__)
+            return BitMask(static_cast<uint32_t>(_mm_movemask_epi8(ctrl_)));
+#else
+            return Scan([](int8_t c) {
+                return c < 0;
+            });
+#endif
+        }
+
+    private:
+#if defined(__SSE2__)
+        __m128i ctrl_;
+#else
+        template <typename Pred>
+        BitMask Scan(Pred pred) const noexcept
+        {
+            uint32_t mask = 0;
+            for (size_t i = 0; i < kGroupWidth; ++i)
+            {
+                mask |= static_cast<uint32_t>(pred(ctrl_[i])) << i;
+            }
+            return BitMask(mask);
+        }
+
+        const int8_t *ctrl_;
+#endif
+    };
+
+    // Хешер по умолчанию. Для строк поддерживает поиск по std::string_view и const char*
+    // без создания временной std::string
+    template <typename K>
+    struct Hash : std::hash<K>
+    {
+    };
+
+    template <>
+    struct Hash<std::string>
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view s) const noexcept
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+
+    template <typename H, typename Eq, typename = void>
+    struct IsTransparent : std::false_type
+    {
+    };
+
+    template <typename H, typename Eq>
+    struct IsTransparent<H, Eq, std::void_t<typename H::is_transparent, typename Eq::is_transparent>>
+        : std::true_type
+    {
+    };
+
+} // namespace flat_hash
+
+template <typename K, typename V, typename Hash = flat_hash::Hash<K>, typename KeyEqual = std::equal_to<>>
+class FlatHashMap
+{
+    using Slot = std::pair<K, V>;
+
+    // Поиск по ключу другого типа доступен, только если хешер и сравнение прозрачные
+    template <typename Q>
+    using EnableLookup = std::enable_if_t<flat_hash::IsTransparent<Hash, KeyEqual>::value && !std::is_same_v<Q, K>>;
+
+public:
+    FlatHashMap() = default;
+
+    FlatHashMap(const FlatHashMap &other)
+        : hash_(other.hash_), eq_(other.eq_)
+    {
+        Reserve(other.size_);
+        other.ForEach([this](const K &key, const V &value) {
+            InsertNew(key, value);
+        });
+    }
+
+    FlatHashMap(FlatHashMap &&other) noexcept
+    {
+        Swap(other);
+    }
+
+    FlatHashMap &operator=(const FlatHashMap &rhs)
+    {
+        if (this != &rhs)
+        {
+            FlatHashMap copy(rhs);
+            Swap(copy);
+        }
+        return *this;
+    }
+
+    FlatHashMap &operator=(FlatHashMap &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            FlatHashMap empty;
+            Swap(empty);
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~FlatHashMap()
+    {
+        DestroySlots();
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return slots_.Capacity();
+    }
+
+    const V *Find(const K &key) const
+    {
+        const size_t index = FindIndex(key);
+        return index != kNotFound ? &slots_[index].second : nullptr;
+    }
+
+    V *Find(const K &key)
+    {
+        return const_cast<V *>(std::as_const(*this).Find(key));
+    }
+
+    // Поиск по ключу другого типа, например std::string_view для строк
+    template <typename Q, typename = EnableLookup<Q>>
+    const V *Find(const Q &key) const
+    {
+        const size_t index = FindIndex(key);
+        return index != kNotFound ? &slots_[index].second : nullptr;
+    }
+
+    template <typename Q, typename = EnableLookup<Q>>
+    V *Find(const Q &key)
+    {
+        return const_cast<V *>(std::as_const(*this).Find(key));
+    }
+
+    bool Contains(const K &key) const
+    {
+        return FindIndex(key) != kNotFound;
+    }
+
+    template <typename Q, typename = EnableLookup<Q>>
+    bool Contains(const Q &key) const
+    {
+        return FindIndex(key) != kNotFound;
+    }
+
+    // Вставляет пару, если ключа ещё нет. Возвращает значение по ключу и признак вставки.
+    // Значение создаётся только при вставке
+    template <typename... Args>
+    std::pair<V *, bool> TryEmplace(K key, Args &&...args)
+    {
+        const size_t hash = HashOf(key);
+        const size_t found = FindIndex(key, hash);
+        if (found != kNotFound)
+        {
+            return {&slots_[found].second, false};
+        }
+        const size_t index = PrepareInsert(hash);
+        new (slots_ + index) Slot(std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                  std::forward_as_tuple(std::forward<Args>(args)...));
+        CommitInsert(index, hash);
+        return {&slots_[index].second, true};
+    }
+
+    std::pair<V *, bool> Insert(K key, V value)
+    {
+        return TryEmplace(std::move(key), std::move(value));
+    }
+
+    void InsertOrAssign(K key, V value)
+    {
+        auto [slot, inserted] = TryEmplace(std::move(key));
+        *slot = std::move(value);
+    }
+
+    V &operator[](K key)
+    {
+        return *TryEmplace(std::move(key)).first;
+    }
+
+    bool Erase(const K &key)
+    {
+        return EraseAt(FindIndex(key));
+    }
+
+    template <typename Q, typename = EnableLookup<Q>>
+    bool Erase(const Q &key)
+    {
+        return EraseAt(FindIndex(key));
+    }
+
+    // Готовит место под n элементов одной перестройкой таблицы
+    void Reserve(size_t n)
+    {
+        if (n <= size_ + growth_left_)
+        {
+            return;
+        }
+        size_t capacity = flat_hash::kGroupWidth;
+        while (flat_hash::MaxLoad(capacity) < n)
+        {
+            capacity *= 2;
+        }
+        Rehash(std::max(capacity, Capacity()));
+    }
+
+    void Clear() noexcept
+    {
+        DestroySlots();
+        std::fill_n(ctrl_.GetAddress(), ctrl_.Capacity(), flat_hash::kEmpty);
+        size_ = 0;
+        growth_left_ = flat_hash::MaxLoad(Capacity());
+    }
+
+    // Вызывает fn(key, value) для каждой пары в порядке ячеек
+    template <typename F>
+    void ForEach(F &&fn) const
+    {
+        for (size_t i = 0; i < Capacity(); ++i)
+        {
+            if (ctrl_[i] >= 0)
+            {
+                fn(std::as_const(slots_[i].first), std::as_const(slots_[i].second));
+            }
+        }
+    }
+
+    template <typename F>
+    void ForEach(F &&fn)
+    {
+        for (size_t i = 0; i < Capacity(); ++i)
+        {
+            if (ctrl_[i] >= 0)
+            {
+                fn(std::as_const(slots_[i].first), slots_[i].second);
+            }
+        }
+    }
+
+    void Swap(FlatHashMap &other) noexcept
+    {
+        slots_.Swap(other.slots_);
+        ctrl_.Swap(other.ctrl_);
+        std::swap(size_, other.size_);
+        std::swap(growth_left_, other.growth_left_);
+        std::swap(hash_, other.hash_);
+        std::swap(eq_, other.eq_);
+    }
+
+private:
+    FlatHashMap(const Hash &hash, const KeyEqual &eq)
+        : hash_(hash), eq_(eq)
+    {
+    }
+
+    static constexpr size_t kNotFound = static_cast<size_t>(-1);
+    // Результат шага пробы: перейти к следующей группе
+    static constexpr size_t kContinue = static_cast<size_t>(-2);
+
+    template <typename Q>
+    size_t HashOf(const Q &key) const
+    {
+        return static_cast<size_t>(flat_hash::Mix(hash_(key)));
+    }
+
+    static int8_t H2(size_t hash) noexcept
+    {
+        return static_cast<int8_t>(hash & 0x7F);
+    }
+
+    // Номер первой группы пробы; младшие 7 бит отданы H2
+    static size_t H1(size_t hash) noexcept
+    {
+        return hash >> 7;
+    }
+
+    // Обходит группы по треугольным числам: при числе групп, равном степени двойки,
+    // каждая группа посещается ровно один раз
+    template <typename F>
+    size_t Probe(size_t hash, F &&visit) const
+    {
+        const size_t group_mask = Capacity() / flat_hash::kGroupWidth - 1;
+        size_t group = H1(hash) & group_mask;
+        for (size_t step = 1;; ++step)
+        {
+            const size_t first = group * flat_hash::kGroupWidth;
+            const size_t result = visit(first, flat_hash::Group(ctrl_ + first));
+            if (result != kContinue)
+            {
+                return result;
+            }
+            group = (group + step) & group_mask;
+        }
+    }
+
+    template <typename Q>
+    size_t FindIndex(const Q &key) const
+    {
+        return FindIndex(key, HashOf(key));
+    }
+
+    template <typename Q>
+    size_t FindIndex(const Q &key, size_t hash) const
+    {
+        if (size_ == 0)
+        {
+            return kNotFound;
+        }
+        return Probe(hash, [&](size_t first, const flat_hash::Group &group) {
+            for (auto match = group.Match(H2(hash)); match; match.Next())
+            {
+                const size_t i = first + match.Lowest();
+                if (eq_(slots_[i].first, key))
+                {
+                    return i;
+                }
+            }
+            // Группа со свободной ячейкой завершает пробу
+            return group.MatchEmpty() ? kNotFound : kContinue;
+        });
+    }
+
+    size_t FindInsertSlot(size_t hash) const
+    {
+        return Probe(hash, [](size_t first, const flat_hash::Group &group) {
+            const auto free = group.MatchEmptyOrDeleted();
+            return free ? first + free.Lowest() : kContinue;
+        });
+    }
+
+    // Ячейка под новый ключ; при нехватке места таблица растёт.
+    // Занимается ячейка только в CommitInsert, после того как элемент создан
+    size_t PrepareInsert(size_t hash)
+    {
+        if (Capacity() == 0)
+        {
+            Rehash(flat_hash::kGroupWidth);
+        }
+        size_t index = FindInsertSlot(hash);
+        if (growth_left_ == 0 && ctrl_[index] != flat_hash::kDeleted)
+        {
+            // Если место съедено метками удалённых, хватит перестройки того же размера
+            const bool mostly_deleted = size_ <= flat_hash::MaxLoad(Capacity()) / 2;
+            Rehash(mostly_deleted ? Capacity() : 2 * Capacity());
+            index = FindInsertSlot(hash);
+        }
+        return index;
+    }
+
+    void CommitInsert(size_t index, size_t hash) noexcept
+    {
+        growth_left_ -= ctrl_[index] == flat_hash::kEmpty;
+        SetCtrl(index, H2(hash));
+        ++size_;
+    }
+
+    // Новая таблица строится рядом со старой, и старая освобождается только после переноса всех
+    // элементов: если хешер или копирование элемента бросит, таблица остаётся прежней
+    void Rehash(size_t new_capacity)
+    {
+        FlatHashMap rebuilt(hash_, eq_);
+        rebuilt.slots_ = RawMemory<Slot>(new_capacity);
+        rebuilt.ctrl_ = RawMemory<int8_t>(new_capacity);
+        std::fill_n(rebuilt.ctrl_.GetAddress(), new_capacity, flat_hash::kEmpty);
+        rebuilt.growth_left_ = flat_hash::MaxLoad(new_capacity);
+
+        // Бросающий хешер вызывается до первого перемещения, пока все элементы на месте
+        constexpr bool kNothrowHash = std::is_nothrow_invocable_v<const Hash &, const K &>;
+        RawMemory<size_t> hashes;
+        if constexpr (!kNothrowHash)
+        {
+            hashes = RawMemory<size_t>(size_);
+            for (size_t i = 0, n = 0; i < Capacity(); ++i)
+            {
+                if (ctrl_[i] >= 0)
+                {
+                    hashes[n++] = HashOf(slots_[i].first);
+                }
+            }
+        }
+
+        for (size_t i = 0, n = 0; i < Capacity(); ++i)
+        {
+            if (ctrl_[i] >= 0)
+            {
+                Slot &slot = slots_[i];
+                size_t hash;
+                if constexpr (kNothrowHash)
+                {
+                    hash = HashOf(slot.first);
+                }
+                else
+                {
+                    hash = hashes[n++];
+                }
+                const size_t index = rebuilt.FindInsertSlot(hash);
+                new (rebuilt.slots_ + index) Slot(std::move_if_noexcept(slot));
+                rebuilt.CommitInsert(index, hash);
+            }
+        }
+        // Старые элементы, в том числе перемещённые, разрушит rebuilt
+        Swap(rebuilt);
+    }
+
+    // Вставка ключа, которого заведомо нет в таблице
+    void InsertNew(const K &key, const V &value)
+    {
+        const size_t hash = HashOf(key);
+        const size_t index = PrepareInsert(hash);
+        new (slots_ + index) Slot(key, value);
+        CommitInsert(index, hash);
+    }
+
+    bool EraseAt(size_t index)
+    {
+        if (index == kNotFound)
+        {
+            return false;
+        }
+        std::destroy_at(slots_ + index);
+        --size_;
+        // Если в группе есть свободная ячейка, поиск на этой группе и так останавливается,
+        // и ячейку можно просто освободить. Иначе нужна метка, чтобы поиск шёл дальше
+        const size_t group = index & ~(flat_hash::kGroupWidth - 1);
+        if (flat_hash::Group(ctrl_ + group).MatchEmpty())
+        {
+            SetCtrl(index, flat_hash::kEmpty);
+            ++growth_left_;
+        }
+        else
+        {
+            SetCtrl(index, flat_hash::kDeleted);
+        }
+        return true;
+    }
+
+    void SetCtrl(size_t index, int8_t value) noexcept
+    {
+        ctrl_[index] = value;
+    }
+
+    void DestroySlots() noexcept
+    {
+        if constexpr (!std::is_trivially_destructible_v<Slot>)
+        {
+            for (size_t i = 0; i < Capacity(); ++i)
+            {
+                if (ctrl_[i] >= 0)
+                {
+                    std::destroy_at(slots_ + i);
+                }
+            }
+        }
+    }
+
+    RawMemory<Slot> slots_;
+    // Выделяется через operator new, который выравнивает не меньше чем на ширину группы
+    RawMemory<int8_t> ctrl_;
+    static_assert(__STDCPP_DEFAULT_NEW_ALIGNMENT__ >= flat_hash::kGroupWidth);
+    size_t size_ = 0;
+    size_t growth_left_ = 0;
+    Hash hash_;
+    KeyEqual eq_;
+};
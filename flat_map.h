@@ -0,0 +1,476 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+// Упорядоченные ассоциативные контейнеры на отсортированных Vector.
+// Ключи и значения лежат в отдельных массивах: поиск читает только плотный массив ключей.
+// Вставка и удаление одного элемента — O(n) сдвигом, поэтому большие наборы
+// добавляются пакетно: сортировка пачки и одно слияние.
+//
+// Для больших таблиц можно включить раскладку Эйцингера: копия ключей в порядке обхода
+// неявного двоичного дерева в ширину. Спуск по ней идёт по соседним ячейкам,
+// а следующие уровни загружаются заранее, тогда как двоичный поиск по отсортированному
+// массиву на каждом шаге промахивается мимо кэша. Индекс перестраивается при каждом изменении.
+enum class FlatLayout
+{
+    Sorted,
+    Eytzinger,
+};
+
+namespace flat_map
+{
+    // Первая позиция в [0, n), где ключ не меньше key. Ветвление только на длине цикла,
+    // сравнение превращается в условную пересылку
+    template <typename K, typename Compare>
+    size_t BranchlessLowerBound(const K *keys, size_t n, const K &key, const Compare &comp)
+    {
+        if (n == 0)
+        {
+            return 0;
+        }
+        const K *base = keys;
+        while (n > 1)
+        {
+            const size_t half = n / 2;
+            base = comp(base[half], key) ? base + half : base;
+            n -= half;
+        }
+        return static_cast<size_t>(base - keys) + comp(*base, key);
+    }
+
+    // Ключи в раскладке Эйцингера (с единицы) и для каждой ячейки — индекс в отсортированном массиве
+    template <typename K, typename Compare>
+    class EytzingerIndex
+    {
+    public:
+        // При исключении индекс остаётся прежним
+        void Build(const Vector<K> &sorted)
+        {
+            const size_t n = sorted.Size();
+            EytzingerIndex built;
+            built.keys_ = Vector<K>(n + 1);
+            built.positions_ = Vector<size_t>(n + 1);
+            size_t next = 0;
+            built.Fill(sorted, next, 1);
+            keys_.Swap(built.keys_);
+            positions_.Swap(built.positions_);
+        }
+
+        void Clear() noexcept
+        {
+            keys_ = Vector<K>();
+            positions_ = Vector<size_t>();
+        }
+
+        bool IsBuilt() const noexcept
+        {
+            return keys_.Size() != 0;
+        }
+
+        // Индекс нижней границы в отсортированном массиве
+        size_t LowerBound(const K &key, const Compare &comp) const
+        {
+            const size_t n = keys_.Size() - 1;
+            const K *keys = keys_.begin();
+            size_t k = 1;
+            while (k <= n)
+            {
+                // Через четыре уровня потомки k занимают 16 подряд идущих ячеек
+                __builtin_prefetch(keys + std::min(16 * k, n));
+                k = 2 * k + comp(keys[k], key);
+            }
+            // Снимаем хвост шагов вправо и последний шаг влево: остаётся ответ или 0
+            k >>= __builtin_ffsll(static_cast<long long>(~k));
+            return k == 0 ? n : positions_[k];
+        }
+
+    private:
+        void Fill(const Vector<K> &sorted, size_t &next, size_t k)
+        {
+            if (k < keys_.Size())
+            {
+                Fill(sorted, next, 2 * k);
+                keys_[k] = sorted[next];
+                positions_[k] = next++;
+                Fill(sorted, next, 2 * k + 1);
+            }
+        }
+
+        Vector<K> keys_;
+        Vector<size_t> positions_;
+    };
+
+    // Отсортированный массив уникальных ключей и необязательный индекс поиска
+    template <typename K, typename Compare>
+    class SortedKeys
+    {
+    public:
+        explicit SortedKeys(const Compare &comp = Compare())
+            : comp_(comp)
+        {
+        }
+
+        size_t Size() const noexcept
+        {
+            return keys_.Size();
+        }
+
+        const Vector<K> &Keys() const noexcept
+        {
+            return keys_;
+        }
+
+        FlatLayout Layout() const noexcept
+        {
+            return layout_;
+        }
+
+        void SetLayout(FlatLayout layout)
+        {
+            layout_ = layout;
+            Reindex();
+        }
+
+        size_t LowerBound(const K &key) const
+        {
+            if (index_.IsBuilt())
+            {
+                return index_.LowerBound(key, comp_);
+            }
+            return BranchlessLowerBound(keys_.begin(), keys_.Size(), key, comp_);
+        }
+
+        // Позиция ключа или Size(), если его нет
+        size_t IndexOf(const K &key) const
+        {
+            const size_t pos = LowerBound(key);
+            return pos != keys_.Size() && !comp_(key, keys_[pos]) ? pos : keys_.Size();
+        }
+
+        bool Equal(const K &lhs, const K &rhs) const
+        {
+            return !comp_(lhs, rhs) && !comp_(rhs, lhs);
+        }
+
+        const Compare &Comp() const noexcept
+        {
+            return comp_;
+        }
+
+        void Swap(SortedKeys &other) noexcept
+        {
+            keys_.Swap(other.keys_);
+            std::swap(comp_, other.comp_);
+            std::swap(layout_, other.layout_);
+            std::swap(index_, other.index_);
+        }
+
+    protected:
+        // Слияние с отсортированными уникальными ключами other: для каждого ключа результата
+        // по возрастанию вызывает emit(свой, nullptr) или emit(nullptr, чужой). При совпадении побеждает свой
+        template <typename Emit>
+        void Merge(Vector<K> &other, Emit &&emit)
+        {
+            K *lhs = keys_.begin();
+            K *rhs = other.begin();
+            while (lhs != keys_.end() || rhs != other.end())
+            {
+                if (rhs == other.end() || (lhs != keys_.end() && !comp_(*rhs, *lhs)))
+                {
+                    if (rhs != other.end() && !comp_(*lhs, *rhs))
+                    {
+                        ++rhs;
+                    }
+                    emit(lhs++, static_cast<K *>(nullptr));
+                }
+                else
+                {
+                    emit(static_cast<K *>(nullptr), rhs++);
+                }
+            }
+        }
+
+        // Вызывается после каждого изменения ключей. Если индекс не построился,
+        // он сбрасывается, и поиск идёт по отсортированным ключам
+        void Reindex()
+        {
+            if (layout_ == FlatLayout::Eytzinger && keys_.Size() != 0)
+            {
+                try
+                {
+                    index_.Build(keys_);
+                }
+                catch (...)
+                {
+                    index_.Clear();
+                    throw;
+                }
+            }
+            else
+            {
+                index_.Clear();
+            }
+        }
+
+        Vector<K> keys_;
+
+    private:
+        Compare comp_;
+        FlatLayout layout_ = FlatLayout::Sorted;
+        EytzingerIndex<K, Compare> index_;
+    };
+
+} // namespace flat_map
+
+template <typename K, typename Compare = std::less<K>>
+class FlatSet : public flat_map::SortedKeys<K, Compare>
+{
+    using Base = flat_map::SortedKeys<K, Compare>;
+
+public:
+    using const_iterator = const K *;
+
+    explicit FlatSet(const Compare &comp = Compare())
+        : Base(comp)
+    {
+    }
+
+    // Строит множество из неотсортированных ключей с повторами
+    explicit FlatSet(Vector<K> keys, const Compare &comp = Compare())
+        : Base(comp)
+    {
+        std::sort(keys.begin(), keys.end(), comp);
+        keys.Erase(std::unique(keys.begin(), keys.end(), [this](const K &lhs, const K &rhs) {
+                       return this->Equal(lhs, rhs);
+                   }),
+                   keys.end());
+        this->keys_ = std::move(keys);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return this->keys_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return this->keys_.end();
+    }
+
+    const K &operator[](size_t index) const noexcept
+    {
+        return this->keys_[index];
+    }
+
+    bool Contains(const K &key) const
+    {
+        return this->IndexOf(key) != this->Size();
+    }
+
+    // false, если ключ уже был
+    bool Insert(K key)
+    {
+        const size_t pos = this->LowerBound(key);
+        if (pos != this->Size() && this->Equal(this->keys_[pos], key))
+        {
+            return false;
+        }
+        this->keys_.Insert(this->keys_.begin() + pos, std::move(key));
+        this->Reindex();
+        return true;
+    }
+
+    bool Erase(const K &key)
+    {
+        const size_t pos = this->IndexOf(key);
+        if (pos == this->Size())
+        {
+            return false;
+        }
+        this->keys_.Erase(this->keys_.begin() + pos);
+        this->Reindex();
+        return true;
+    }
+
+    // Добавляет пачку ключей одним слиянием
+    void InsertBatch(Vector<K> keys)
+    {
+        FlatSet run(std::move(keys), this->Comp());
+        Vector<K> merged;
+        merged.Reserve(this->Size() + run.Size());
+        // Свои ключи перемещаются, только если перемещение не бросает: иначе при исключении
+        // множество осталось бы с перемещёнными ключами
+        this->Merge(run.keys_, [&](K *lhs, K *rhs) {
+            if (lhs != nullptr)
+            {
+                merged.PushBack(std::move_if_noexcept(*lhs));
+            }
+            else
+            {
+                merged.PushBack(std::move(*rhs));
+            }
+        });
+        this->keys_ = std::move(merged);
+        this->Reindex();
+    }
+};
+
+template <typename K, typename V, typename Compare = std::less<K>>
+class FlatMap : public flat_map::SortedKeys<K, Compare>
+{
+    using Base = flat_map::SortedKeys<K, Compare>;
+
+public:
+    explicit FlatMap(const Compare &comp = Compare())
+        : Base(comp)
+    {
+    }
+
+    // Строит словарь из неотсортированных пар; из пар с одинаковым ключом остаётся первая
+    explicit FlatMap(Vector<std::pair<K, V>> items, const Compare &comp = Compare())
+        : Base(comp)
+    {
+        std::stable_sort(items.begin(), items.end(), [&comp](const auto &lhs, const auto &rhs) {
+            return comp(lhs.first, rhs.first);
+        });
+        this->keys_.Reserve(items.Size());
+        values_.Reserve(items.Size());
+        for (auto &item : items)
+        {
+            if (this->keys_.Size() == 0 || !this->Equal(this->keys_[this->keys_.Size() - 1], item.first))
+            {
+                this->keys_.PushBack(std::move(item.first));
+                values_.PushBack(std::move(item.second));
+            }
+        }
+    }
+
+    const Vector<V> &Values() const noexcept
+    {
+        return values_;
+    }
+
+    const K &KeyAt(size_t index) const noexcept
+    {
+        return this->keys_[index];
+    }
+
+    const V &ValueAt(size_t index) const noexcept
+    {
+        return values_[index];
+    }
+
+    V &ValueAt(size_t index) noexcept
+    {
+        return values_[index];
+    }
+
+    bool Contains(const K &key) const
+    {
+        return this->IndexOf(key) != this->Size();
+    }
+
+    // Указатель на значение или nullptr
+    const V *Find(const K &key) const
+    {
+        const size_t pos = this->IndexOf(key);
+        return pos != this->Size() ? &values_[pos] : nullptr;
+    }
+
+    V *Find(const K &key)
+    {
+        return const_cast<V *>(std::as_const(*this).Find(key));
+    }
+
+    // Значение по ключу; отсутствующий ключ вставляется со значением по умолчанию
+    V &operator[](const K &key)
+    {
+        return *Insert(key, V()).first;
+    }
+
+    // Вставляет пару, если ключа ещё нет. Возвращает значение по ключу и признак вставки
+    std::pair<V *, bool> Insert(K key, V value)
+    {
+        const size_t pos = this->LowerBound(key);
+        if (pos != this->Size() && this->Equal(this->keys_[pos], key))
+        {
+            return {&values_[pos], false};
+        }
+        this->keys_.Insert(this->keys_.begin() + pos, std::move(key));
+        try
+        {
+            values_.Insert(values_.begin() + pos, std::move(value));
+        }
+        catch (...)
+        {
+            // Ключ без значения сдвинул бы соответствие ключей и значений
+            this->keys_.Erase(this->keys_.begin() + pos);
+            throw;
+        }
+        this->Reindex();
+        return {&values_[pos], true};
+    }
+
+    void InsertOrAssign(K key, V value)
+    {
+        if (V *slot = Find(key))
+        {
+            *slot = std::move(value);
+        }
+        else
+        {
+            Insert(std::move(key), std::move(value));
+        }
+    }
+
+    bool Erase(const K &key)
+    {
+        const size_t pos = this->IndexOf(key);
+        if (pos == this->Size())
+        {
+            return false;
+        }
+        this->keys_.Erase(this->keys_.begin() + pos);
+        values_.Erase(values_.begin() + pos);
+        this->Reindex();
+        return true;
+    }
+
+    // Добавляет пачку пар одним слиянием. Уже имеющиеся ключи не перезаписываются
+    void InsertBatch(Vector<std::pair<K, V>> items)
+    {
+        FlatMap run(std::move(items), this->Comp());
+        Vector<K> merged_keys;
+        Vector<V> merged_values;
+        merged_keys.Reserve(this->Size() + run.Size());
+        merged_values.Reserve(this->Size() + run.Size());
+        // Свои пары перемещаются, только если перемещение не бросает: при исключении словарь не меняется
+        this->Merge(run.keys_, [&](K *lhs, K *rhs) {
+            if (lhs != nullptr)
+            {
+                merged_keys.PushBack(std::move_if_noexcept(*lhs));
+                merged_values.PushBack(std::move_if_noexcept(values_[lhs - this->keys_.begin()]));
+            }
+            else
+            {
+                merged_keys.PushBack(std::move(*rhs));
+                merged_values.PushBack(std::move(run.values_[rhs - run.keys_.begin()]));
+            }
+        });
+        this->keys_ = std::move(merged_keys);
+        values_ = std::move(merged_values);
+        this->Reindex();
+    }
+
+    void Swap(FlatMap &other) noexcept
+    {
+        Base::Swap(other);
+        values_.Swap(other.values_);
+    }
+
+private:
+    Vector<V> values_;
+};
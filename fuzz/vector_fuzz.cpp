@@ -0,0 +1,650 @@
+// Дифференциальная проверка Vector, Vector<T, uint32_t>, ThinVector и GapVector против std::vector: один и тот же поток
+// операций, разобранный из входных байтов, применяется к проверяемому контейнеру и к std::vector,
+// и после каждого шага сравниваются размеры, элементы и число живых объектов. Элементы следят за своим адресом,
+// поэтому побайтовое перемещение нетривиального типа или обращение к разрушенному объекту
+// тоже обнаруживается. Для элементов с бросающим перемещением отдельная операция прерывает вставку
+// исключением из перемещения и проверяет, что контейнер не изменился. Заодно копятся распределения
+// задержек каждой операции.
+//
+// С -DVECTOR_FUZZ_LIBFUZZER и -fsanitize=fuzzer это цель libFuzzer. Без него — детерминированный
+// драйвер: «vec_fuzz [runs] [seed]» гоняет случайные входы, «vec_fuzz file...» воспроизводит
+// сохранённые входы (например, crash-файлы libFuzzer)
+#include "gap_vector.h"
+#include "thin_vector.h"
+#include "vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+#ifdef VECTOR_FUZZ_LIBFUZZER
+// Под libFuzzer задержки не копятся: прогонов миллионы, а замеры искажены санитайзерами
+constexpr bool MEASURE_LATENCY = false;
+#else
+constexpr bool MEASURE_LATENCY = true;
+#endif
+
+// Больше шагов на вход не нужно: длинные потоки только замедляют поиск
+constexpr size_t MAX_STEPS = 4096;
+
+const char* current_type = "";
+size_t current_step = 0;
+const char* current_op = "";
+
+[[noreturn]] void Fail(const char* what) {
+    std::fprintf(stderr, "vector_fuzz: %s (type %s, step %zu, op %s)\n", what, current_type, current_step,
+                 current_op);
+    std::abort();
+}
+
+void Expect(bool condition, const char* what) {
+    if (!condition) {
+        Fail(what);
+    }
+}
+
+// Элемент, который считает живые экземпляры и помнит свой адрес. Если контейнер скопирует
+// его байты на новое место или обратится к нему после разрушения, адрес не совпадёт.
+// При NothrowMove = false контейнеры переносят элементы копированием, а перемещающий
+// конструктор бросает исключение, когда обнулится moves_before_throw
+template <bool NothrowMove>
+class Tracked {
+public:
+    Tracked()
+        : Tracked(0) {
+    }
+
+    Tracked(int value)
+        : value_(value)
+        , self_(this) {
+        ++live;
+    }
+
+    Tracked(const Tracked& other)
+        : value_(other.Value())
+        , self_(this) {
+        ++live;
+    }
+
+    Tracked(Tracked&& other) noexcept(NothrowMove)
+        : value_(other.Value())
+        , self_(this) {
+        if constexpr (!NothrowMove) {
+            if (moves_before_throw >= 0 && moves_before_throw-- == 0) {
+                throw std::runtime_error("move failed");
+            }
+        }
+        other.value_ = MOVED_FROM;
+        ++live;
+    }
+
+    Tracked& operator=(const Tracked& other) {
+        CheckAlive();
+        value_ = other.Value();
+        return *this;
+    }
+
+    Tracked& operator=(Tracked&& other) noexcept(NothrowMove) {
+        CheckAlive();
+        const int value = other.Value();
+        other.value_ = MOVED_FROM;
+        value_ = value;
+        return *this;
+    }
+
+    ~Tracked() {
+        CheckAlive();
+        self_ = nullptr;
+        --live;
+    }
+
+    int Value() const {
+        CheckAlive();
+        return value_;
+    }
+
+    bool operator==(const Tracked& other) const {
+        return Value() == other.Value();
+    }
+
+    static inline long live = 0;
+    static inline int moves_before_throw = -1;
+
+private:
+    static constexpr int MOVED_FROM = -1;
+
+    void CheckAlive() const {
+        if (self_ != this) {
+            Fail("element used after destruction or relocated bytewise");
+        }
+    }
+
+    int value_;
+    const Tracked* self_;
+};
+
+template <typename T>
+int ValueOf(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<int>(value);
+    } else {
+        return value.Value();
+    }
+}
+
+enum class Op {
+    PushCopy,
+    PushMove,
+    EmplaceBack,
+    PushOwn,
+    Insert,
+    InsertOwn,
+    Erase,
+    EraseRange,
+    EraseUnordered,
+    EraseIf,
+    EraseUnorderedIf,
+    PopBack,
+    Reserve,
+    Resize,
+    CopyAssign,
+    SelfCopyAssign,
+    MoveAssign,
+    CopyConstruct,
+    MoveConstruct,
+    Swap,
+    InsertThrowing,
+    Count,
+};
+
+const char* OpName(Op op) {
+    static const char* const NAMES[] = {
+        "PushCopy",   "PushMove",         "EmplaceBack", "PushOwn",        "Insert",     "InsertOwn",    "Erase",
+        "EraseRange", "EraseUnordered",   "EraseIf",     "EraseUnorderedIf", "PopBack",  "Reserve",      "Resize",
+        "CopyAssign", "SelfCopyAssign",   "MoveAssign",  "CopyConstruct",  "MoveConstruct", "Swap",
+        "InsertThrowing"};
+    static_assert(std::size(NAMES) == static_cast<size_t>(Op::Count));
+    return NAMES[static_cast<size_t>(op)];
+}
+
+constexpr size_t OP_COUNT = static_cast<size_t>(Op::Count);
+
+// Задержки в наносекундах: [операция][0 — проверяемый контейнер, 1 — std::vector]
+struct Latencies {
+    std::vector<uint32_t> samples[OP_COUNT][2];
+};
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+void Timed(Latencies& latencies, Op op, int container, F&& fn) {
+    if constexpr (MEASURE_LATENCY) {
+        const auto start = Clock::now();
+        fn();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        latencies.samples[static_cast<size_t>(op)][container].push_back(static_cast<uint32_t>(ns));
+    } else {
+        (void)latencies;
+        (void)op;
+        (void)container;
+        fn();
+    }
+}
+
+class FuzzInput {
+public:
+    FuzzInput(const uint8_t* data, size_t size)
+        : data_(data)
+        , size_(size) {
+    }
+
+    bool Empty() const {
+        return position_ == size_;
+    }
+
+    uint8_t Byte() {
+        return position_ < size_ ? data_[position_++] : 0;
+    }
+
+    // Число из [0, bound)
+    size_t Below(size_t bound) {
+        const size_t value = static_cast<size_t>(Byte()) | static_cast<size_t>(Byte()) << 8;
+        return bound != 0 ? value % bound : 0;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_ = 0;
+};
+
+// Удаление без сохранения порядка так же, как делает Vector::EraseUnordered
+template <typename T>
+void ModelEraseUnordered(std::vector<T>& v, size_t index) {
+    if (index + 1 != v.size()) {
+        v[index] = std::move(v.back());
+    }
+    v.pop_back();
+}
+
+// GapVector удаляет только по одному элементу: групповые удаления для него пропускаются
+template <template <typename> class Container>
+inline constexpr bool HAS_BULK_ERASE = true;
+
+template <>
+inline constexpr bool HAS_BULK_ERASE<GapVector> = false;
+
+// Два проверяемых контейнера и две модели на std::vector: операции с двумя контейнерами
+// берут второй из пары
+template <template <typename> class Container, typename T>
+class Differential {
+public:
+    explicit Differential(Latencies* latencies)
+        : latencies_(latencies) {
+    }
+
+    void Run(FuzzInput& input) {
+        for (current_step = 0; !input.Empty() && current_step < MAX_STEPS; ++current_step) {
+            Step(input);
+            Verify();
+        }
+    }
+
+private:
+    void Step(FuzzInput& input) {
+        const uint8_t code = input.Byte();
+        const int t = code & 1;
+        const Op op = static_cast<Op>((code >> 1) % OP_COUNT);
+        current_op = OpName(op);
+        Container<T>& v = vectors_[t];
+        Container<T>& other = vectors_[1 - t];
+        std::vector<T>& m = models_[t];
+        std::vector<T>& other_model = models_[1 - t];
+        const size_t size = m.size();
+
+        switch (op) {
+            case Op::PushCopy: {
+                const T value(input.Byte());
+                Timed(op, 0, [&] { v.PushBack(value); });
+                Timed(op, 1, [&] { m.push_back(value); });
+                break;
+            }
+            case Op::PushMove: {
+                T value(input.Byte());
+                T model_value(value);
+                Timed(op, 0, [&] { v.PushBack(std::move(value)); });
+                Timed(op, 1, [&] { m.push_back(std::move(model_value)); });
+                break;
+            }
+            case Op::EmplaceBack: {
+                const int value = input.Byte();
+                Timed(op, 0, [&] { v.EmplaceBack(value); });
+                Timed(op, 1, [&] { m.emplace_back(value); });
+                break;
+            }
+            case Op::PushOwn: {
+                // Ссылка на собственный элемент должна пережить перевыделение
+                if (size == 0) {
+                    break;
+                }
+                const size_t source = input.Below(size);
+                Timed(op, 0, [&] { v.PushBack(v[source]); });
+                Timed(op, 1, [&] { m.push_back(m[source]); });
+                break;
+            }
+            case Op::Insert: {
+                const size_t index = input.Below(size + 1);
+                const int value = input.Byte();
+                Timed(op, 0, [&] { v.Emplace(v.cbegin() + index, value); });
+                Timed(op, 1, [&] { m.emplace(m.cbegin() + index, value); });
+                break;
+            }
+            case Op::InsertOwn: {
+                // Вставляемое значение лежит в самом векторе и сдвигается вместе с хвостом
+                if (size == 0) {
+                    break;
+                }
+                const size_t index = input.Below(size + 1);
+                const size_t source = input.Below(size);
+                Timed(op, 0, [&] { v.Insert(v.cbegin() + index, v[source]); });
+                Timed(op, 1, [&] { m.insert(m.cbegin() + index, m[source]); });
+                break;
+            }
+            case Op::Erase: {
+                if (size == 0) {
+                    break;
+                }
+                const size_t index = input.Below(size);
+                Timed(op, 0, [&] { v.Erase(v.cbegin() + index); });
+                Timed(op, 1, [&] { m.erase(m.cbegin() + index); });
+                break;
+            }
+            case Op::EraseRange: {
+                if constexpr (!HAS_BULK_ERASE<Container>) {
+                    break;
+                } else {
+                    const size_t first = input.Below(size + 1);
+                    const size_t count = input.Below(size - first + 1);
+                    Timed(op, 0, [&] { v.Erase(v.cbegin() + first, v.cbegin() + first + count); });
+                    Timed(op, 1, [&] { m.erase(m.cbegin() + first, m.cbegin() + first + count); });
+                    break;
+                }
+            }
+            case Op::EraseUnordered: {
+                if constexpr (!HAS_BULK_ERASE<Container>) {
+                    break;
+                } else {
+                    if (size == 0) {
+                        break;
+                    }
+                    const size_t index = input.Below(size);
+                    Timed(op, 0, [&] { v.EraseUnordered(v.cbegin() + index); });
+                    Timed(op, 1, [&] { ModelEraseUnordered(m, index); });
+                    break;
+                }
+            }
+            case Op::EraseIf: {
+                if constexpr (!HAS_BULK_ERASE<Container>) {
+                    break;
+                } else {
+                    const int divisor = input.Byte() % 4 + 2;
+                    const auto pred = [divisor](const T& value) { return ValueOf(value) % divisor == 0; };
+                    size_t erased = 0;
+                    Timed(op, 0, [&] { erased = v.EraseIf(pred); });
+                    Timed(op, 1, [&] { m.erase(std::remove_if(m.begin(), m.end(), pred), m.end()); });
+                    Expect(erased == size - m.size(), "EraseIf returned a wrong count");
+                    break;
+                }
+            }
+            case Op::EraseUnorderedIf: {
+                if constexpr (!HAS_BULK_ERASE<Container>) {
+                    break;
+                } else {
+                    const int divisor = input.Byte() % 4 + 2;
+                    const auto pred = [divisor](const T& value) { return ValueOf(value) % divisor == 0; };
+                    size_t erased = 0;
+                    Timed(op, 0, [&] { erased = v.EraseUnorderedIf(pred); });
+                    Timed(op, 1, [&] {
+                        for (size_t i = 0; i < m.size();) {
+                            if (pred(m[i])) {
+                                ModelEraseUnordered(m, i);
+                            } else {
+                                ++i;
+                            }
+                        }
+                    });
+                    Expect(erased == size - m.size(), "EraseUnorderedIf returned a wrong count");
+                    break;
+                }
+            }
+            case Op::PopBack: {
+                if (size == 0) {
+                    break;
+                }
+                Timed(op, 0, [&] { v.PopBack(); });
+                Timed(op, 1, [&] { m.pop_back(); });
+                break;
+            }
+            case Op::Reserve: {
+                const size_t capacity = input.Byte();
+                Timed(op, 0, [&] { v.Reserve(capacity); });
+                Timed(op, 1, [&] { m.reserve(capacity); });
+                Expect(v.Capacity() >= capacity, "Reserve left a smaller capacity");
+                break;
+            }
+            case Op::Resize: {
+                const size_t new_size = input.Byte();
+                Timed(op, 0, [&] { v.Resize(new_size); });
+                Timed(op, 1, [&] { m.resize(new_size); });
+                break;
+            }
+            case Op::CopyAssign: {
+                Timed(op, 0, [&] { v = other; });
+                Timed(op, 1, [&] { m = other_model; });
+                break;
+            }
+            case Op::SelfCopyAssign: {
+                const Container<T>& self = v;
+                const std::vector<T>& model_self = m;
+                Timed(op, 0, [&] { v = self; });
+                Timed(op, 1, [&] { m = model_self; });
+                break;
+            }
+            case Op::MoveAssign: {
+                Timed(op, 0, [&] { v = std::move(other); });
+                Timed(op, 1, [&] { m = std::move(other_model); });
+                // Vector после перемещения пуст; у std::vector состояние не задано стандартом
+                other_model.clear();
+                break;
+            }
+            case Op::CopyConstruct: {
+                std::optional<Container<T>> copy;
+                std::optional<std::vector<T>> model_copy;
+                Timed(op, 0, [&] { copy.emplace(other); });
+                Timed(op, 1, [&] { model_copy.emplace(other_model); });
+                v = std::move(*copy);
+                m = std::move(*model_copy);
+                break;
+            }
+            case Op::MoveConstruct: {
+                std::optional<Container<T>> moved;
+                std::optional<std::vector<T>> model_moved;
+                Timed(op, 0, [&] { moved.emplace(std::move(other)); });
+                Timed(op, 1, [&] { model_moved.emplace(std::move(other_model)); });
+                other_model.clear();
+                v = std::move(*moved);
+                m = std::move(*model_moved);
+                break;
+            }
+            case Op::Swap: {
+                Timed(op, 0, [&] { v.Swap(other); });
+                Timed(op, 1, [&] { m.swap(other_model); });
+                break;
+            }
+            case Op::InsertThrowing: {
+                // Перемещение бросает посреди вставки: контейнер должен остаться прежним
+                const size_t index = input.Below(size + 1);
+                const int value = input.Byte();
+                const int moves_before_throw = input.Byte() % 8;
+                if constexpr (!std::is_nothrow_move_constructible_v<T>) {
+                    bool thrown = false;
+                    T::moves_before_throw = moves_before_throw;
+                    try {
+                        v.Emplace(v.cbegin() + index, value);
+                    } catch (const std::runtime_error&) {
+                        thrown = true;
+                    }
+                    T::moves_before_throw = -1;
+                    if (!thrown) {
+                        m.emplace(m.cbegin() + index, value);
+                    }
+                }
+                break;
+            }
+            case Op::Count:
+                break;
+        }
+    }
+
+    template <typename F>
+    void Timed(Op op, int container, F&& fn) {
+        ::Timed(*latencies_, op, container, std::forward<F>(fn));
+    }
+
+    void Verify() const {
+        long elements = 0;
+        for (int k = 0; k < 2; ++k) {
+            const Container<T>& v = vectors_[k];
+            const std::vector<T>& m = models_[k];
+            Expect(v.Size() == m.size(), "size differs from std::vector");
+            Expect(v.Capacity() >= v.Size(), "capacity is less than size");
+            Expect(static_cast<size_t>(v.end() - v.begin()) == v.Size(), "iterator range differs from size");
+            for (size_t i = 0; i < m.size(); ++i) {
+                Expect(v[i] == m[i], "element differs from std::vector");
+            }
+            elements += static_cast<long>(v.Size() + m.size());
+        }
+        if constexpr (!std::is_arithmetic_v<T>) {
+            Expect(T::live == elements, "live element count differs from container sizes");
+        }
+    }
+
+    Latencies* latencies_;
+    Container<T> vectors_[2];
+    std::vector<T> models_[2];
+};
+
+template <typename T>
+using CompactVector = Vector<T, uint32_t>;
+
+struct TypeLatencies {
+    const char* name;
+    Latencies latencies;
+};
+
+TypeLatencies type_latencies[] = {
+    {"Vector<int>", {}},     {"Vector<Tracked>", {}},     {"Vector<Tracked<copy>>", {}},
+    {"ThinVector<int>", {}}, {"ThinVector<Tracked>", {}}, {"ThinVector<Tracked<copy>>", {}},
+    {"Vector<int, u32>", {}}, {"Vector<Tracked, u32>", {}}, {"Vector<Tracked<copy>, u32>", {}},
+    {"GapVector<int>", {}},  {"GapVector<Tracked>", {}},  {"GapVector<Tracked<copy>>", {}},
+};
+
+template <template <typename> class Container, typename T>
+void RunType(size_t type_index, const uint8_t* data, size_t size) {
+    current_type = type_latencies[type_index].name;
+    {
+        FuzzInput input(data, size);
+        Differential<Container, T>(&type_latencies[type_index].latencies).Run(input);
+    }
+    if constexpr (!std::is_arithmetic_v<T>) {
+        Expect(T::live == 0, "elements leaked after the containers were destroyed");
+    }
+}
+
+void RunInput(const uint8_t* data, size_t size) {
+    RunType<Vector, int>(0, data, size);
+    RunType<Vector, Tracked<true>>(1, data, size);
+    RunType<Vector, Tracked<false>>(2, data, size);
+    RunType<ThinVector, int>(3, data, size);
+    RunType<ThinVector, Tracked<true>>(4, data, size);
+    RunType<ThinVector, Tracked<false>>(5, data, size);
+    RunType<CompactVector, int>(6, data, size);
+    RunType<CompactVector, Tracked<true>>(7, data, size);
+    RunType<CompactVector, Tracked<false>>(8, data, size);
+    RunType<GapVector, int>(9, data, size);
+    RunType<GapVector, Tracked<true>>(10, data, size);
+    RunType<GapVector, Tracked<false>>(11, data, size);
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    RunInput(data, size);
+    return 0;
+}
+
+#ifndef VECTOR_FUZZ_LIBFUZZER
+
+namespace {
+
+bool ReadFile(const char* path, std::vector<uint8_t>& bytes) {
+    FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    bytes.clear();
+    uint8_t buffer[4096];
+    for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    const bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+// Цена пустого замера, вычитается из задержек
+uint32_t ClockOverhead() {
+    uint32_t best = UINT32_MAX;
+    for (int i = 0; i < 1000; ++i) {
+        const auto start = Clock::now();
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        best = std::min(best, static_cast<uint32_t>(ns));
+    }
+    return best;
+}
+
+uint32_t Percentile(const std::vector<uint32_t>& sorted, double p) {
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+void PrintLatencies() {
+    const uint32_t overhead = ClockOverhead();
+    std::printf("latency in ns, clock overhead of %u ns subtracted\n", overhead);
+    std::printf("%-26s %-17s %9s %27s %27s\n", "container", "op", "calls", "p50/p90/p99/max",
+                "std::vector p50/p90/p99/max");
+    for (TypeLatencies& type : type_latencies) {
+        for (size_t op = 0; op < OP_COUNT; ++op) {
+            auto& samples = type.latencies.samples[op];
+            if (samples[0].empty()) {
+                continue;
+            }
+            std::printf("%-26s %-17s %9zu", type.name, OpName(static_cast<Op>(op)), samples[0].size());
+            for (auto& s : samples) {
+                for (uint32_t& ns : s) {
+                    ns = ns > overhead ? ns - overhead : 0;
+                }
+                std::sort(s.begin(), s.end());
+                std::printf(" %6u/%6u/%6u/%6u", Percentile(s, 0.5), Percentile(s, 0.9), Percentile(s, 0.99), s.back());
+            }
+            std::printf("\n");
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    char* end = nullptr;
+    const unsigned long long runs = argc > 1 ? std::strtoull(argv[1], &end, 10) : 2000;
+    if (argc > 1 && *end != '\0') {
+        // Воспроизведение сохранённых входов
+        std::vector<uint8_t> bytes;
+        for (int i = 1; i < argc; ++i) {
+            if (!ReadFile(argv[i], bytes)) {
+                std::fprintf(stderr, "cannot read %s\n", argv[i]);
+                return 1;
+            }
+            RunInput(bytes.data(), bytes.size());
+            std::printf("%s: ok\n", argv[i]);
+        }
+        return 0;
+    }
+    const unsigned long long seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<size_t> length(1, 2048);
+    std::vector<uint8_t> bytes;
+    for (unsigned long long run = 0; run < runs; ++run) {
+        bytes.resize(length(rng));
+        for (uint8_t& byte : bytes) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        RunInput(bytes.data(), bytes.size());
+    }
+    std::printf("runs: %llu, seed: %llu, all operations matched std::vector\n", runs, seed);
+    PrintLatencies();
+    return 0;
+}
+
+#endif
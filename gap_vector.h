@@ -0,0 +1,461 @@
+#pragma once
+#include "vector.h"
+
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+// Вектор с подвижным "зазором" (gap buffer). Элементы хранятся двумя отрезками:
+// [0, gap_begin_) и [gap_end_, Capacity()), между ними — неинициализированная память.
+// Вставка и удаление рядом с зазором стоят O(1), перенос зазора — O(расстояние),
+// поэтому серия правок около одного "курсора" выполняется за амортизированное O(1).
+template <typename T>
+class GapVector
+{
+    template <bool IsConst>
+    class Iterator
+    {
+        using Owner = std::conditional_t<IsConst, const GapVector, GapVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T *, T *>;
+        using reference = std::conditional_t<IsConst, const T &, T &>;
+
+        Iterator() = default;
+
+        Iterator(Owner *owner, size_t index) noexcept
+            : owner_(owner), index_(index)
+        {
+        }
+
+        // Неконстантный итератор неявно приводится к константному
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Iterator(const Iterator<OtherConst> &other) noexcept
+            : owner_(other.owner_), index_(other.index_)
+        {
+        }
+
+        reference operator*() const noexcept
+        {
+            return (*owner_)[index_];
+        }
+        pointer operator->() const noexcept
+        {
+            return &(*owner_)[index_];
+        }
+        reference operator[](difference_type offset) const noexcept
+        {
+            return (*owner_)[index_ + offset];
+        }
+
+        Iterator &operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept
+        {
+            auto old = *this;
+            ++index_;
+            return old;
+        }
+        Iterator &operator--() noexcept
+        {
+            --index_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept
+        {
+            auto old = *this;
+            --index_;
+            return old;
+        }
+        Iterator &operator+=(difference_type offset) noexcept
+        {
+            index_ += offset;
+            return *this;
+        }
+        Iterator &operator-=(difference_type offset) noexcept
+        {
+            index_ -= offset;
+            return *this;
+        }
+        friend Iterator operator+(Iterator it, difference_type offset) noexcept
+        {
+            return it += offset;
+        }
+        friend Iterator operator+(difference_type offset, Iterator it) noexcept
+        {
+            return it += offset;
+        }
+        friend Iterator operator-(Iterator it, difference_type offset) noexcept
+        {
+            return it -= offset;
+        }
+        friend difference_type operator-(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+        friend bool operator<(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ < rhs.index_;
+        }
+        friend bool operator>(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ > rhs.index_;
+        }
+        friend bool operator<=(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ <= rhs.index_;
+        }
+        friend bool operator>=(const Iterator &lhs, const Iterator &rhs) noexcept
+        {
+            return lhs.index_ >= rhs.index_;
+        }
+
+        size_t Index() const noexcept
+        {
+            return index_;
+        }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Owner *owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    GapVector() = default;
+
+    explicit GapVector(size_t size)
+        : data_(size), gap_begin_(size), gap_end_(size) //
+    {
+        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+    }
+
+    GapVector(const GapVector &other)
+        : data_(other.Size()), gap_begin_(other.Size()), gap_end_(other.Size()) //
+    {
+        // Копия хранит все элементы подряд, зазор — в конце
+        std::uninitialized_copy_n(other.data_.GetAddress(), other.gap_begin_, data_.GetAddress());
+        try
+        {
+            std::uninitialized_copy_n(other.data_.GetAddress() + other.gap_end_, other.SuffixSize(),
+                                      data_.GetAddress() + other.gap_begin_);
+        }
+        catch (...)
+        {
+            std::destroy_n(data_.GetAddress(), other.gap_begin_);
+            throw;
+        }
+    }
+
+    GapVector(GapVector &&other) noexcept
+        : data_{std::move(other.data_)},
+          gap_begin_{std::exchange(other.gap_begin_, 0)},
+          gap_end_{std::exchange(other.gap_end_, 0)}
+    {
+    }
+
+    GapVector &operator=(const GapVector &rhs)
+    {
+        if (this != &rhs)
+        {
+            GapVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    GapVector &operator=(GapVector &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            GapVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~GapVector()
+    {
+        std::destroy_n(data_.GetAddress(), gap_begin_);
+        std::destroy_n(data_.GetAddress() + gap_end_, SuffixSize());
+    }
+
+    iterator begin() noexcept
+    {
+        return {this, 0};
+    }
+    iterator end() noexcept
+    {
+        return {this, Size()};
+    }
+    const_iterator begin() const noexcept
+    {
+        return {this, 0};
+    }
+    const_iterator end() const noexcept
+    {
+        return {this, Size()};
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return data_.Capacity() - (gap_end_ - gap_begin_);
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return data_.Capacity();
+    }
+
+    // Логическая позиция зазора: следующая вставка в эту позицию не сдвигает элементы
+    size_t GapPosition() const noexcept
+    {
+        return gap_begin_;
+    }
+
+    const T &operator[](size_t index) const noexcept
+    {
+        return const_cast<GapVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return data_[index < gap_begin_ ? index : index + (gap_end_ - gap_begin_)];
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= data_.Capacity())
+        {
+            return;
+        }
+
+        RawMemory<T> new_data(new_capacity);
+        const size_t suffix_size = SuffixSize();
+        const size_t new_gap_end = new_capacity - suffix_size;
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+        {
+            std::uninitialized_move_n(data_.GetAddress(), gap_begin_, new_data.GetAddress());
+            std::uninitialized_move_n(data_.GetAddress() + gap_end_, suffix_size,
+                                      new_data.GetAddress() + new_gap_end);
+        }
+        else
+        {
+            std::uninitialized_copy_n(data_.GetAddress(), gap_begin_, new_data.GetAddress());
+            try
+            {
+                std::uninitialized_copy_n(data_.GetAddress() + gap_end_, suffix_size,
+                                          new_data.GetAddress() + new_gap_end);
+            }
+            catch (...)
+            {
+                std::destroy_n(new_data.GetAddress(), gap_begin_);
+                throw;
+            }
+        }
+
+        std::destroy_n(data_.GetAddress(), gap_begin_);
+        std::destroy_n(data_.GetAddress() + gap_end_, suffix_size);
+        data_.Swap(new_data);
+        gap_end_ = new_gap_end;
+    }
+
+    void Resize(size_t new_size)
+    {
+        const size_t size = Size();
+        if (new_size < size)
+        {
+            if (new_size < gap_begin_)
+            {
+                std::destroy_n(data_.GetAddress() + new_size, gap_begin_ - new_size);
+                gap_begin_ = new_size;
+            }
+            else
+            {
+                // Остающиеся элементы правого отрезка переезжают к левому
+                MoveGapTo(new_size);
+            }
+            std::destroy_n(data_.GetAddress() + gap_end_, SuffixSize());
+            gap_end_ = data_.Capacity();
+            return;
+        }
+
+        if (new_size > size)
+        {
+            Reserve(new_size);
+            MoveGapTo(size);
+            std::uninitialized_value_construct_n(data_.GetAddress() + gap_begin_, new_size - size);
+            gap_begin_ += new_size - size;
+        }
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args &&...args)
+    {
+        const size_t index = pos.Index();
+        assert(index <= Size());
+
+        // Аргументы могут ссылаться на элементы самого вектора, а перенос зазора
+        // и реаллокация перемещают элементы. Поэтому сначала создаём значение.
+        T value(std::forward<Args>(args)...);
+        if (gap_begin_ == gap_end_)
+        {
+            Reserve(data_.Capacity() == 0 ? 1 : 2 * data_.Capacity());
+        }
+        MoveGapTo(index);
+        new (data_.GetAddress() + gap_begin_) T(std::move(value));
+        ++gap_begin_;
+        return {this, index};
+    }
+
+    iterator Insert(const_iterator pos, const T &value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T &&value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args)
+    {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T &value)
+    {
+        Emplace(cend(), value);
+    }
+
+    void PushBack(T &&value)
+    {
+        Emplace(cend(), std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        const size_t index = pos.Index();
+        assert(index < Size());
+
+        // Удаляемый элемент оказывается на границе зазора и просто поглощается им.
+        // Удаление слева от курсора (backspace) и справа (delete) не сдвигает элементы.
+        if (index < gap_begin_)
+        {
+            MoveGapTo(index + 1);
+            --gap_begin_;
+            std::destroy_at(data_.GetAddress() + gap_begin_);
+        }
+        else
+        {
+            MoveGapTo(index);
+            std::destroy_at(data_.GetAddress() + gap_end_);
+            ++gap_end_;
+        }
+        return {this, index};
+    }
+
+    void PopBack()
+    {
+        Erase(cend() - 1);
+    }
+
+    void Swap(GapVector &other) noexcept
+    {
+        data_.Swap(other.data_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+    }
+
+private:
+    size_t SuffixSize() const noexcept
+    {
+        return data_.Capacity() - gap_end_;
+    }
+
+    // Переносит зазор так, чтобы он начинался с логической позиции index.
+    // Для нетривиальных T зазор сдвигается по одному элементу: если перемещение бросит
+    // исключение, границы зазора уже соответствуют перенесённым элементам, а порядок
+    // элементов не меняется
+    void MoveGapTo(size_t index)
+    {
+        if (gap_begin_ == gap_end_)
+        {
+            // Пустой зазор переносится без перемещения элементов
+            gap_begin_ = gap_end_ = index;
+            return;
+        }
+        T *buf = data_.GetAddress();
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            if (index < gap_begin_)
+            {
+                // Элементы [index, gap_begin_) переезжают в конец зазора
+                const size_t count = gap_begin_ - index;
+                std::memmove(static_cast<void *>(buf + gap_end_ - count), static_cast<const void *>(buf + index),
+                             count * sizeof(T));
+                gap_begin_ = index;
+                gap_end_ -= count;
+            }
+            else if (index > gap_begin_)
+            {
+                // Первые элементы правого отрезка переезжают в начало зазора
+                const size_t count = index - gap_begin_;
+                std::memmove(static_cast<void *>(buf + gap_begin_), static_cast<const void *>(buf + gap_end_),
+                             count * sizeof(T));
+                gap_begin_ += count;
+                gap_end_ += count;
+            }
+        }
+        else
+        {
+            while (index < gap_begin_)
+            {
+                new (buf + gap_end_ - 1) T(std::move(buf[gap_begin_ - 1]));
+                std::destroy_at(buf + gap_begin_ - 1);
+                --gap_begin_;
+                --gap_end_;
+            }
+            while (index > gap_begin_)
+            {
+                new (buf + gap_begin_) T(std::move(buf[gap_end_]));
+                std::destroy_at(buf + gap_end_);
+                ++gap_begin_;
+                ++gap_end_;
+            }
+        }
+    }
+
+    RawMemory<T> data_;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+};
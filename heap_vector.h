@@ -0,0 +1,429 @@
+#pragma once
+#include "vector.h"
+
+#include <functional>
+#include <limits>
+#include <utility>
+
+// Двоичная куча на Vector спускается на уровень за сравнение, и каждый уровень —
+// новая кэш-линия. В 4-арной куче дерево вдвое ниже, а четыре потомка узла лежат рядом,
+// так что выбор лучшего из них обходится одной линией.
+// Сдвиги выполняются «дыркой»: элемент перемещается один раз в конечную позицию,
+// а не обменивается на каждом уровне.
+namespace heap_vector
+{
+    inline constexpr size_t kArity = 4;
+
+    inline size_t Parent(size_t index) noexcept
+    {
+        return (index - 1) / kArity;
+    }
+
+    inline size_t FirstChild(size_t index) noexcept
+    {
+        return index * kArity + 1;
+    }
+
+    // Поднимает value из дырки index. place(value, i) перемещает значение в ячейку i
+    template <typename T, typename Less, typename Place>
+    void SiftUp(T *data, size_t index, T value, const Less &less, Place &&place)
+    {
+        while (index > 0)
+        {
+            const size_t parent = Parent(index);
+            if (!less(data[parent], value))
+            {
+                break;
+            }
+            place(std::move(data[parent]), index);
+            index = parent;
+        }
+        place(std::move(value), index);
+    }
+
+    // Опускает value из дырки index в куче из size элементов
+    template <typename T, typename Less, typename Place>
+    void SiftDown(T *data, size_t size, size_t index, T value, const Less &less, Place &&place)
+    {
+        while (true)
+        {
+            const size_t first = FirstChild(index);
+            if (first >= size)
+            {
+                break;
+            }
+            const size_t last = std::min(first + kArity, size);
+            size_t best = first;
+            for (size_t child = first + 1; child < last; ++child)
+            {
+                best = less(data[best], data[child]) ? child : best;
+            }
+            if (!less(value, data[best]))
+            {
+                break;
+            }
+            place(std::move(data[best]), index);
+            index = best;
+        }
+        place(std::move(value), index);
+    }
+
+    // Построение кучи снизу вверх (Флойд): O(n) против O(n log n) у поэлементной вставки
+    template <typename T, typename Less, typename Place>
+    void Heapify(T *data, size_t size, const Less &less, Place &&place)
+    {
+        if (size < 2)
+        {
+            return;
+        }
+        for (size_t i = Parent(size - 1) + 1; i-- > 0;)
+        {
+            SiftDown(data, size, i, std::move(data[i]), less, place);
+        }
+    }
+
+    // Выгоднее ли перестроить кучу целиком, чем вставить count элементов по одному
+    inline bool PreferHeapify(size_t size, size_t count) noexcept
+    {
+        size_t depth = 1;
+        for (size_t n = size + count; n >= kArity; n /= kArity)
+        {
+            ++depth;
+        }
+        return count * depth > size + count;
+    }
+
+} // namespace heap_vector
+
+// Очередь с приоритетом: Top() — наибольший по Compare элемент, как у std::priority_queue
+template <typename T, typename Compare = std::less<T>>
+class HeapVector
+{
+public:
+    explicit HeapVector(const Compare &comp = Compare())
+        : comp_(comp)
+    {
+    }
+
+    // Строит кучу из произвольных значений за O(n)
+    explicit HeapVector(Vector<T> values, const Compare &comp = Compare())
+        : data_(std::move(values)), comp_(comp)
+    {
+        heap_vector::Heapify(data_.begin(), data_.Size(), comp_, Placer());
+    }
+
+    size_t Size() const noexcept
+    {
+        return data_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return data_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        data_.Reserve(capacity);
+    }
+
+    const T &Top() const noexcept
+    {
+        assert(!Empty());
+        return data_[0];
+    }
+
+    template <typename... Args>
+    void Emplace(Args &&...args)
+    {
+        data_.EmplaceBack(std::forward<Args>(args)...);
+        const size_t index = data_.Size() - 1;
+        heap_vector::SiftUp(data_.begin(), index, std::move(data_[index]), comp_, Placer());
+    }
+
+    void Push(const T &value)
+    {
+        Emplace(value);
+    }
+
+    void Push(T &&value)
+    {
+        Emplace(std::move(value));
+    }
+
+    // Добавляет пачку: при большой пачке куча перестраивается целиком
+    void PushBatch(const T *values, size_t count)
+    {
+        const size_t old_size = data_.Size();
+        if (old_size + count > data_.Capacity())
+        {
+            data_.Reserve(std::max(old_size + count, 2 * data_.Capacity()));
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            data_.PushBack(values[i]);
+        }
+        RestoreAfterAppend(old_size);
+    }
+
+    void PushBatch(Vector<T> values)
+    {
+        const size_t old_size = data_.Size();
+        if (old_size + values.Size() > data_.Capacity())
+        {
+            data_.Reserve(std::max(old_size + values.Size(), 2 * data_.Capacity()));
+        }
+        for (T &value : values)
+        {
+            data_.PushBack(std::move(value));
+        }
+        RestoreAfterAppend(old_size);
+    }
+
+    // Извлекает вершину
+    T Pop()
+    {
+        assert(!Empty());
+        T top = std::move(data_[0]);
+        RemoveTop();
+        return top;
+    }
+
+    // Дописывает в out до n вершин в порядке убывания приоритета. Возвращает число извлечённых
+    size_t PopN(size_t n, Vector<T> &out)
+    {
+        n = std::min(n, data_.Size());
+        if (out.Size() + n > out.Capacity())
+        {
+            out.Reserve(std::max(out.Size() + n, 2 * out.Capacity()));
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            out.PushBack(std::move(data_[0]));
+            RemoveTop();
+        }
+        return n;
+    }
+
+    // Заменяет вершину одним спуском вместо Pop и Push. Основа отбора top-K:
+    // в куче с обратным сравнением K лучших, новый кандидат вытесняет худшего
+    void ReplaceTop(T value)
+    {
+        assert(!Empty());
+        heap_vector::SiftDown(data_.begin(), data_.Size(), 0, std::move(value), comp_, Placer());
+    }
+
+    // Элементы в порядке кучи
+    const Vector<T> &Data() const noexcept
+    {
+        return data_;
+    }
+
+    void Clear()
+    {
+        data_.Erase(data_.begin(), data_.end());
+    }
+
+private:
+    auto Placer() noexcept
+    {
+        return [data = data_.begin()](T &&value, size_t index) {
+            data[index] = std::move(value);
+        };
+    }
+
+    void RestoreAfterAppend(size_t old_size)
+    {
+        const size_t count = data_.Size() - old_size;
+        if (heap_vector::PreferHeapify(old_size, count))
+        {
+            heap_vector::Heapify(data_.begin(), data_.Size(), comp_, Placer());
+            return;
+        }
+        for (size_t i = old_size; i < data_.Size(); ++i)
+        {
+            heap_vector::SiftUp(data_.begin(), i, std::move(data_[i]), comp_, Placer());
+        }
+    }
+
+    void RemoveTop()
+    {
+        const size_t last = data_.Size() - 1;
+        if (last != 0)
+        {
+            T value = std::move(data_[last]);
+            data_.PopBack();
+            heap_vector::SiftDown(data_.begin(), last, 0, std::move(value), comp_, Placer());
+        }
+        else
+        {
+            data_.PopBack();
+        }
+    }
+
+    Vector<T> data_;
+    Compare comp_;
+};
+
+// Куча элементов с номерами 0, 1, 2, ... и индексом позиций, позволяющим менять приоритет
+// элемента по номеру (алгоритм Дейкстры, таймеры). Номера должны быть небольшими:
+// индекс — массив размером с наибольший номер
+template <typename T, typename Compare = std::less<T>>
+class IndexedHeapVector
+{
+    struct Entry
+    {
+        T value;
+        size_t id;
+    };
+
+    struct EntryLess
+    {
+        bool operator()(const Entry &lhs, const Entry &rhs) const
+        {
+            return comp(lhs.value, rhs.value);
+        }
+
+        Compare comp;
+    };
+
+    static constexpr size_t kAbsent = std::numeric_limits<size_t>::max();
+
+public:
+    explicit IndexedHeapVector(const Compare &comp = Compare())
+        : less_{comp}
+    {
+    }
+
+    size_t Size() const noexcept
+    {
+        return data_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return data_.Size() == 0;
+    }
+
+    bool Contains(size_t id) const noexcept
+    {
+        return id < positions_.Size() && positions_[id] != kAbsent;
+    }
+
+    const T &Get(size_t id) const noexcept
+    {
+        assert(Contains(id));
+        return data_[positions_[id]].value;
+    }
+
+    const T &Top() const noexcept
+    {
+        assert(!Empty());
+        return data_[0].value;
+    }
+
+    size_t TopId() const noexcept
+    {
+        assert(!Empty());
+        return data_[0].id;
+    }
+
+    void Push(size_t id, T value)
+    {
+        assert(!Contains(id));
+        while (positions_.Size() <= id)
+        {
+            positions_.PushBack(kAbsent);
+        }
+        data_.PushBack(Entry{std::move(value), id});
+        const size_t index = data_.Size() - 1;
+        heap_vector::SiftUp(data_.begin(), index, std::move(data_[index]), less_, Placer());
+    }
+
+    // Извлекает вершину: номер и значение
+    std::pair<size_t, T> Pop()
+    {
+        assert(!Empty());
+        Entry top = std::move(data_[0]);
+        positions_[top.id] = kAbsent;
+        const size_t last = data_.Size() - 1;
+        if (last != 0)
+        {
+            Entry entry = std::move(data_[last]);
+            data_.PopBack();
+            heap_vector::SiftDown(data_.begin(), last, 0, std::move(entry), less_, Placer());
+        }
+        else
+        {
+            data_.PopBack();
+        }
+        return {top.id, std::move(top.value)};
+    }
+
+    // Повышает приоритет элемента — для Compare = std::greater это уменьшение ключа
+    void DecreaseKey(size_t id, T value)
+    {
+        assert(Contains(id));
+        const size_t index = positions_[id];
+        assert(!less_.comp(value, data_[index].value));
+        heap_vector::SiftUp(data_.begin(), index, Entry{std::move(value), id}, less_, Placer());
+    }
+
+    // Меняет значение элемента в любую сторону
+    void Update(size_t id, T value)
+    {
+        assert(Contains(id));
+        const size_t index = positions_[id];
+        if (less_.comp(data_[index].value, value))
+        {
+            heap_vector::SiftUp(data_.begin(), index, Entry{std::move(value), id}, less_, Placer());
+        }
+        else
+        {
+            heap_vector::SiftDown(data_.begin(), data_.Size(), index, Entry{std::move(value), id}, less_, Placer());
+        }
+    }
+
+    bool Erase(size_t id)
+    {
+        if (!Contains(id))
+        {
+            return false;
+        }
+        const size_t index = positions_[id];
+        positions_[id] = kAbsent;
+        const size_t last = data_.Size() - 1;
+        if (index != last)
+        {
+            Entry entry = std::move(data_[last]);
+            data_.PopBack();
+            // Последний элемент может оказаться как лучше, так и хуже удалённого
+            if (index > 0 && less_(data_[heap_vector::Parent(index)], entry))
+            {
+                heap_vector::SiftUp(data_.begin(), index, std::move(entry), less_, Placer());
+            }
+            else
+            {
+                heap_vector::SiftDown(data_.begin(), last, index, std::move(entry), less_, Placer());
+            }
+        }
+        else
+        {
+            data_.PopBack();
+        }
+        return true;
+    }
+
+private:
+    auto Placer() noexcept
+    {
+        return [data = data_.begin(), positions = positions_.begin()](Entry &&entry, size_t index) {
+            positions[entry.id] = index;
+            data[index] = std::move(entry);
+        };
+    }
+
+    Vector<Entry> data_;
+    Vector<size_t> positions_;
+    EntryLess less_;
+};
@@ -0,0 +1,258 @@
+#pragma once
+#include "vector.h"
+
+#include <cassert>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+// Строки переменной длины в плоской раскладке (CSR): все элементы лежат подряд в Values(),
+// строка i — это [Offsets()[i], Offsets()[i + 1]). Получается из Vector<Vector<T>> функцией
+// Freeze, которая заменяет по буферу на строку двумя буферами на всё. Число строк и их длины
+// после построения не меняются, значения элементов — можно.
+template <typename T>
+class JaggedVector
+{
+public:
+    // Строка: представление над элементами с интерфейсом Vector для доступа
+    template <typename Value>
+    class RowView
+    {
+    public:
+        using iterator = Value *;
+        using const_iterator = const Value *;
+
+        RowView(Value *data, size_t size) noexcept
+            : data_(data), size_(size)
+        {
+        }
+
+        iterator begin() const noexcept
+        {
+            return data_;
+        }
+        iterator end() const noexcept
+        {
+            return data_ + size_;
+        }
+        const_iterator cbegin() const noexcept
+        {
+            return data_;
+        }
+        const_iterator cend() const noexcept
+        {
+            return data_ + size_;
+        }
+
+        size_t Size() const noexcept
+        {
+            return size_;
+        }
+
+        Value &operator[](size_t index) const noexcept
+        {
+            assert(index < size_);
+            return data_[index];
+        }
+
+    private:
+        Value *data_;
+        size_t size_;
+    };
+
+    using Row = RowView<T>;
+    using ConstRow = RowView<const T>;
+
+    // Перебор строк: разыменование даёт RowView
+    template <bool IsConst>
+    class RowIterator
+    {
+        using Owner = std::conditional_t<IsConst, const JaggedVector, JaggedVector>;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::conditional_t<IsConst, ConstRow, Row>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        RowIterator(Owner *owner, size_t index) noexcept
+            : owner_(owner), index_(index)
+        {
+        }
+
+        value_type operator*() const noexcept
+        {
+            return (*owner_)[index_];
+        }
+
+        RowIterator &operator++() noexcept
+        {
+            ++index_;
+            return *this;
+        }
+        RowIterator operator++(int) noexcept
+        {
+            auto old = *this;
+            ++index_;
+            return old;
+        }
+
+        friend bool operator==(const RowIterator &lhs, const RowIterator &rhs) noexcept
+        {
+            return lhs.index_ == rhs.index_;
+        }
+        friend bool operator!=(const RowIterator &lhs, const RowIterator &rhs) noexcept
+        {
+            return lhs.index_ != rhs.index_;
+        }
+
+    private:
+        Owner *owner_;
+        size_t index_;
+    };
+
+    using iterator = RowIterator<false>;
+    using const_iterator = RowIterator<true>;
+
+    JaggedVector() = default;
+
+    // offsets — Size() + 1 неубывающих смещений от 0 до values.Size(); для нуля строк допустим пустой
+    JaggedVector(Vector<size_t> offsets, Vector<T> values) noexcept
+        : offsets_(std::move(offsets)), values_(std::move(values))
+    {
+        assert(offsets_.Size() == 0 ? values_.Size() == 0
+                                    : offsets_[0] == 0 && offsets_[offsets_.Size() - 1] == values_.Size());
+    }
+
+    // Число строк
+    size_t Size() const noexcept
+    {
+        return offsets_.Size() == 0 ? 0 : offsets_.Size() - 1;
+    }
+
+    // Число элементов во всех строках
+    size_t TotalSize() const noexcept
+    {
+        return values_.Size();
+    }
+
+    Row operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return Row(values_.begin() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    ConstRow operator[](size_t index) const noexcept
+    {
+        assert(index < Size());
+        return ConstRow(values_.begin() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    iterator begin() noexcept
+    {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept
+    {
+        return iterator(this, Size());
+    }
+    const_iterator begin() const noexcept
+    {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept
+    {
+        return const_iterator(this, Size());
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    const Vector<size_t> &Offsets() const noexcept
+    {
+        return offsets_;
+    }
+
+    const Vector<T> &Values() const noexcept
+    {
+        return values_;
+    }
+
+    void Swap(JaggedVector &other) noexcept
+    {
+        offsets_.Swap(other.offsets_);
+        values_.Swap(other.values_);
+    }
+
+private:
+    Vector<size_t> offsets_;
+    Vector<T> values_;
+};
+
+namespace jagged_detail
+{
+    // Общая часть Freeze: Element(value) возвращает копию или rvalue-ссылку на элемент строки
+    template <typename T, typename Rows, typename Element>
+    JaggedVector<T> Freeze(Rows &rows, Element element)
+    {
+        const size_t count = rows.Size();
+        Vector<size_t> offsets(count + 1);
+        size_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += rows[i].Size();
+            offsets[i + 1] = total;
+        }
+
+        Vector<T> values;
+        if constexpr (std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>)
+        {
+            // Построчное копирование памяти без проверки вместимости на каждый элемент
+            values.Resize(total);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (rows[i].Size() != 0)
+                {
+                    std::memcpy(static_cast<void *>(values.begin() + offsets[i]),
+                                static_cast<const void *>(rows[i].begin()), rows[i].Size() * sizeof(T));
+                }
+            }
+        }
+        else
+        {
+            values.Reserve(total);
+            for (size_t i = 0; i < count; ++i)
+            {
+                for (auto &value : rows[i])
+                {
+                    values.EmplaceBack(element(value));
+                }
+            }
+        }
+        return JaggedVector<T>(std::move(offsets), std::move(values));
+    }
+} // namespace jagged_detail
+
+// Копирует строки в плоскую раскладку
+template <typename T, typename RowSize, typename RowAllocator, typename SizeType, typename Allocator>
+JaggedVector<T> Freeze(const Vector<Vector<T, RowSize, RowAllocator>, SizeType, Allocator> &rows)
+{
+    return jagged_detail::Freeze<T>(rows, [](const T &value) -> const T & { return value; });
+}
+
+// Переносит элементы в плоскую раскладку и освобождает строки: rows остаётся пустым,
+// так что после этого арену, из которой выделялись строки, можно сбросить
+template <typename T, typename RowSize, typename RowAllocator, typename SizeType, typename Allocator>
+JaggedVector<T> Freeze(Vector<Vector<T, RowSize, RowAllocator>, SizeType, Allocator> &&rows)
+{
+    JaggedVector<T> result = jagged_detail::Freeze<T>(rows, [](T &value) -> T && { return std::move(value); });
+    Vector<Vector<T, RowSize, RowAllocator>, SizeType, Allocator> consumed(std::move(rows));
+    return result;
+}
@@ -1,10 +1,40 @@
 #include "vector.h"
+#include "gap_vector.h"
+#include "vector_simd.h"
+#include "vector_expr.h"
+#include "mapped_vector.h"
+#include "vector_serialize.h"
+#include "shared_vector.h"
+#include "vector_stream.h"
+#include "packed_int_vector.h"
+#include "bit_vector.h"
+#include "flat_map.h"
+#include "flat_hash_map.h"
+#include "slot_map.h"
+#include "heap_vector.h"
+#include "jagged_vector.h"
+#include "thin_vector.h"
+#include "vector_arena.h"
+#include "vector_record.h"
+#include "vector_stats.h"
 
+#include <atomic>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include <sys/wait.h>
+
 namespace {
 
 // "Магическое" число, используемое для отслеживания живости объекта
@@ -558,6 +588,664 @@ void Test6() {
     }
 }
 
+void Test7() {
+    using namespace std::literals;
+    const int ID = 42;
+    {
+        // Правки около курсора сверяем с std::vector
+        GapVector<int> v;
+        std::vector<int> expected;
+        size_t cursor = 0;
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 100 == 0) {
+                cursor = expected.size() / 2;
+            }
+            if (i % 7 == 3 && cursor > 0) {
+                v.Erase(v.cbegin() + (cursor - 1));
+                expected.erase(expected.begin() + (cursor - 1));
+                --cursor;
+            } else {
+                auto pos = v.Emplace(v.cbegin() + cursor, i);
+                expected.insert(expected.begin() + cursor, i);
+                assert(*pos == i);
+                ++cursor;
+            }
+        }
+        assert(v.Size() == expected.size());
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        const GapVector<int> copy(v);
+        assert(copy.Size() == v.Size());
+        assert(std::equal(copy.begin(), copy.end(), expected.begin()));
+        assert(copy.end() - copy.begin() == static_cast<std::ptrdiff_t>(copy.Size()));
+    }
+    {
+        // Вставки подряд в одну позицию не сдвигают хвост
+        const size_t SIZE = 100;
+        Obj::ResetCounters();
+        GapVector<Obj> v(SIZE);
+        v.Reserve(SIZE * 4);
+        v.Emplace(v.cbegin() + SIZE / 2, 0);
+        const int moved_after_first = Obj::num_moved;
+        for (int i = 1; i <= static_cast<int>(SIZE); ++i) {
+            auto pos = v.Emplace(v.cbegin() + SIZE / 2 + i, i, "x"s);
+            assert(pos->id == i);
+        }
+        // Одно перемещение на вставку: из временного значения в зазор
+        assert(Obj::num_moved - moved_after_first == static_cast<int>(SIZE));
+        assert(Obj::num_copied == 0);
+        assert(v.Size() == SIZE * 2 + 1);
+        assert(v.GapPosition() == SIZE / 2 + SIZE + 1);
+
+        const int moved_before_erase = Obj::num_moved;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.Erase(v.cbegin() + v.GapPosition() - 1);
+        }
+        assert(Obj::num_moved == moved_before_erase);
+        assert(v.Size() == SIZE + 1);
+        assert(v[SIZE / 2].id == 0);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE + 1));
+
+        v.Resize(SIZE / 4);
+        assert(v.Size() == SIZE / 4);
+        v.PushBack(Obj{ID});
+        assert(v[SIZE / 4].id == ID);
+        v.PopBack();
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 4));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        GapVector<TestObj> v(1);
+        // Вставка существующего элемента безопасна даже при реаллокации
+        v.Insert(v.cbegin(), v[0]);
+        v.EmplaceBack(v[1]);
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+    {
+        // Перенос зазора, прерванный исключением, не теряет и не удваивает элементы
+        static int alive = 0;
+        static int moves_before_throw = -1;
+        struct ThrowingMove {
+            explicit ThrowingMove(int id)
+                : id(id)  //
+            {
+                ++alive;
+            }
+            ThrowingMove(const ThrowingMove& other)
+                : id(other.id)  //
+            {
+                ++alive;
+            }
+            ThrowingMove(ThrowingMove&& other)
+                : id(other.id)  //
+            {
+                if (moves_before_throw >= 0 && moves_before_throw-- == 0) {
+                    throw std::runtime_error("Oops");
+                }
+                ++alive;
+            }
+            ThrowingMove& operator=(const ThrowingMove&) = default;
+            ~ThrowingMove() {
+                --alive;
+            }
+            int id;
+        };
+        const auto ids = [](const GapVector<ThrowingMove>& v) {
+            std::vector<int> result;
+            for (const ThrowingMove& obj : v) {
+                result.push_back(obj.id);
+            }
+            return result;
+        };
+        {
+            GapVector<ThrowingMove> v;
+            v.Reserve(16);
+            for (int i = 0; i < 8; ++i) {
+                v.EmplaceBack(i);
+            }
+            // Третье перемещение при переносе зазора в начало бросает исключение
+            moves_before_throw = 2;
+            try {
+                v.Emplace(v.cbegin(), 100);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 8 && v.GapPosition() == 6);
+            assert(ids(v) == (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+            assert(alive == 8);
+
+            // То же при переносе вправо
+            moves_before_throw = 1;
+            try {
+                v.EmplaceBack(100);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 8 && v.GapPosition() == 7);
+            assert(ids(v) == (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7}));
+            moves_before_throw = -1;
+            v.Emplace(v.cbegin(), 100);
+            assert(ids(v) == (std::vector<int>{100, 0, 1, 2, 3, 4, 5, 6, 7}));
+        }
+        assert(alive == 0);
+    }
+    {
+        // Удаление из заполненного вектора: зазор пуст, и переносить его нечего
+        GapVector<std::string> v(3);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i] = std::string(40, static_cast<char>('a' + i));
+        }
+        assert(v.Size() == v.Capacity());
+        v.Erase(v.cbegin());
+        assert(v.Size() == 2 && v[0] == std::string(40, 'b') && v[1] == std::string(40, 'c'));
+        v.Emplace(v.cbegin() + 1, 40, 'x');
+        assert(v.Size() == 3 && v[1] == std::string(40, 'x') && v[2] == std::string(40, 'c'));
+    }
+}
+
+void Test8() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto* pos = v.EraseUnordered(v.cbegin() + 10);
+        assert(pos == v.begin() + 10);
+        assert(pos->id == static_cast<int>(SIZE - 1));
+        assert(v.Size() == SIZE - 1);
+        assert(Obj::num_move_assigned == 1);
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_copied == 0);
+
+        pos = v.EraseUnordered(v.cend() - 1);
+        assert(pos == v.end());
+        assert(v.Size() == SIZE - 2);
+        assert(Obj::num_move_assigned == 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE - 2));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        const size_t removed = v.EraseUnorderedIf([](const Obj& obj) {
+            return obj.id % 3 == 0;
+        });
+        // Не больше одного перемещения на удалённый элемент
+        assert(removed == (SIZE + 2) / 3);
+        assert(v.Size() == SIZE - removed);
+        assert(Obj::num_move_assigned <= static_cast<int>(removed));
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_copied == 0);
+        assert(Obj::num_destroyed == static_cast<int>(removed));
+        assert(std::none_of(v.begin(), v.end(), [](const Obj& obj) {
+            return obj.id % 3 == 0;
+        }));
+        int sum = 0;
+        for (const Obj& obj : v) {
+            sum += obj.id;
+        }
+        int expected_sum = 0;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            expected_sum += i % 3 == 0 ? 0 : i;
+        }
+        assert(sum == expected_sum);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+template <typename T>
+void CheckEraseValue() {
+    const size_t SIZE = 1000;
+    Vector<T> v(SIZE);
+    std::vector<T> expected(SIZE);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < SIZE; ++i) {
+        seed = seed * 1103515245 + 12345;
+        v[i] = expected[i] = static_cast<T>((seed >> 16) % 5);
+    }
+    const T value = static_cast<T>(3);
+    expected.erase(std::remove(expected.begin(), expected.end(), value), expected.end());
+
+    const size_t erased = EraseValue(v, value);
+    assert(erased == SIZE - expected.size());
+    assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+#if VECTOR_SIMD_X86
+    if constexpr (vector_simd::kHasCompactKernel<T>) {
+        // Каждое доступное ядро сверяем со скалярным
+        Vector<T> w(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            w[i] = static_cast<T>(i % 7);
+        }
+        Vector<T> scalar(w);
+        const size_t kept = vector_simd::CompactNotEqualScalar(scalar.begin(), 0, 0, SIZE, T{2});
+        if (vector_simd::CpuHasAvx2()) {
+            Vector<T> avx2(w);
+            assert(vector_simd::CompactNotEqualAvx2(avx2.begin(), SIZE, T{2}) == kept);
+            assert(std::equal(avx2.begin(), avx2.begin() + kept, scalar.begin()));
+        }
+        if (vector_simd::CpuHasAvx512()) {
+            Vector<T> avx512(w);
+            assert(vector_simd::CompactNotEqualAvx512(avx512.begin(), SIZE, T{2}) == kept);
+            assert(std::equal(avx512.begin(), avx512.begin() + kept, scalar.begin()));
+        }
+    }
+#endif
+}
+
+void Test9() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto* pos = v.Erase(v.cbegin() + 10, v.cbegin() + 30);
+        assert(pos == v.begin() + 10);
+        assert(pos->id == 30);
+        assert(v.Size() == SIZE - 20);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE - 30));
+        assert(Obj::num_destroyed == 20);
+        assert(v.Erase(v.cbegin() + 5, v.cbegin() + 5) == v.begin() + 5);
+        assert(v.Size() == SIZE - 20);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        const size_t erased = v.EraseIf([](const Obj& obj) {
+            return obj.id % 2 == 1;
+        });
+        assert(erased == SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id == static_cast<int>(2 * i));
+        }
+        // Один проход: каждый оставшийся элемент перемещается не более одного раза
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE / 2 - 1));
+        assert(Obj::num_destroyed == static_cast<int>(SIZE / 2));
+        assert(Obj::num_copied == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+        v.Erase(v.cbegin(), v.cbegin() + 3);
+        assert(v.Size() == SIZE - 3 && v[0] == 3);
+        assert(v.EraseIf([](int x) {
+            return x >= 50;
+        }) == SIZE - 50);
+        assert(v.Size() == 47 && v[46] == 49);
+    }
+    CheckEraseValue<int32_t>();
+    CheckEraseValue<uint32_t>();
+    CheckEraseValue<float>();
+    CheckEraseValue<int64_t>();
+    CheckEraseValue<uint64_t>();
+    CheckEraseValue<double>();
+    CheckEraseValue<int16_t>();
+    {
+        using namespace std::literals;
+        Vector<std::string> v(3);
+        v[0] = "a"s;
+        v[1] = "b"s;
+        v[2] = "a"s;
+        assert(EraseValue(v, "a"s) == 2);
+        assert(v.Size() == 1 && v[0] == "b"s);
+    }
+}
+
+template <typename T>
+void CheckSearchKernels(size_t size) {
+    Vector<T> v(size);
+    uint32_t seed = 777;
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1103515245 + 12345;
+        v[i] = static_cast<T>((seed >> 16) % 1000);
+    }
+    const T absent = static_cast<T>(5000);
+    for (const T value : {v[size / 2], v[size - 1], absent}) {
+        assert(Find(v, value) == std::find(v.begin(), v.end(), value));
+        assert(Contains(v, value) == (std::find(v.begin(), v.end(), value) != v.end()));
+        assert(Count(v, value) == static_cast<size_t>(std::count(v.begin(), v.end(), value)));
+    }
+    assert(Find(v, absent) == v.end());
+
+    const auto [min, max] = MinMax(v);
+    const auto [min_it, max_it] = std::minmax_element(v.begin(), v.end());
+    assert(min == *min_it && max == *max_it);
+    assert(ArgMin(v) == static_cast<size_t>(std::min_element(v.begin(), v.end()) - v.begin()));
+
+    // Значения — целые меньше 1000, поэтому даже сумма float считается точно
+    double expected_sum = 0;
+    for (const T x : v) {
+        expected_sum += static_cast<double>(x);
+    }
+    assert(static_cast<double>(Sum(v)) == expected_sum);
+}
+
+void Test10() {
+    for (size_t size : {1, 7, 100, 1000, 4099}) {
+        CheckSearchKernels<int32_t>(size);
+        CheckSearchKernels<uint32_t>(size);
+        CheckSearchKernels<float>(size);
+        CheckSearchKernels<uint64_t>(size);
+        CheckSearchKernels<int64_t>(size);
+        CheckSearchKernels<double>(size);
+        CheckSearchKernels<int16_t>(size);
+    }
+    {
+        Vector<int> v;
+        assert(Find(v, 1) == v.end());
+        assert(!Contains(v, 1));
+        assert(Count(v, 1) == 0);
+        assert(Sum(v) == 0);
+    }
+    {
+        Vector<int32_t> v(10);
+        v[3] = std::numeric_limits<int32_t>::max();
+        v[4] = std::numeric_limits<int32_t>::max();
+        // Сумма целых не переполняется
+        assert(Sum(v) == 2 * int64_t{std::numeric_limits<int32_t>::max()});
+        v[7] = -1;
+        v[8] = -1;
+        assert(ArgMin(v) == 7);
+        *Find(v, -1) = 0;
+        assert(ArgMin(v) == 8);
+    }
+}
+
+void Test11() {
+    const size_t SIZE = 100;
+    Vector<double> b(SIZE);
+    Vector<double> c(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        b[i] = static_cast<double>(i);
+        c[i] = -static_cast<double>(i) * 3;
+    }
+    {
+        const double k = 2.5;
+        Vector<double> a = b * k + c;
+        assert(a.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(a[i] == b[i] * k + c[i]);
+        }
+
+        // Присваивание в вектор с достаточной вместимостью не выделяет память
+        const double* old_data = a.begin();
+        a = Fma(a, b, 1.0) - Abs(c) / 2 + -b;
+        assert(a.begin() == old_data);
+        for (size_t i = 0; i < SIZE; ++i) {
+            const double prev = b[i] * k + c[i];
+            assert(a[i] == prev * b[i] + 1.0 - std::abs(c[i]) / 2 + -b[i]);
+        }
+
+        a = Sqrt(b * b);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(a[i] == b[i]);
+        }
+        a = 1 - b / 4;
+        assert(a[8] == -1.0);
+    }
+    {
+        // Размер результата берётся из выражения
+        Vector<double> a(SIZE * 2);
+        a = c - b;
+        assert(a.Size() == SIZE);
+        assert(a[1] == -4.0);
+        Vector<double> small;
+        small = Fma(2, b, c);
+        assert(small.Size() == SIZE);
+        assert(small[10] == -10.0);
+    }
+    {
+        // Скаляры приводятся к типу элементов вектора
+        Vector<float> f(4);
+        f = f + 0.5;
+        f = f * f;
+        assert(f[3] == 0.25f);
+        Vector<int> v(3);
+        v = Abs(v - 7);
+        assert(v[0] == 7);
+    }
+}
+
+void Test12() {
+    const std::string path = "/tmp/vec_mapped_test_" + std::to_string(::getpid());
+    ::unlink(path.c_str());
+    const size_t SIZE = 10'000;
+    {
+        MappedVector<uint64_t> v(path);
+        assert(v.IsOpen());
+        assert(v.Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i * i);
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() >= SIZE);
+        v.EmplaceBack(v[1]);
+        v.PopBack();
+        v.Flush();
+    }
+    {
+        // Повторное открытие видит те же данные без десериализации
+        MappedVector<uint64_t> v(path);
+        assert(v.Size() == SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == i * i);
+        }
+        v.Resize(SIZE * 3);
+        assert(v[SIZE * 3 - 1] == 0);
+        v.Resize(SIZE / 2);
+
+        MappedVector<uint64_t> moved(std::move(v));
+        assert(!v.IsOpen());
+        assert(moved.Size() == SIZE / 2);
+        assert(*(moved.end() - 1) == (SIZE / 2 - 1) * (SIZE / 2 - 1));
+    }
+    {
+        MappedVector<uint64_t> v(path);
+        assert(v.Size() == SIZE / 2);
+        assert(v.Capacity() >= SIZE * 3);
+        // Произведение вместимости на размер элемента переполнило бы size_t
+        const size_t capacity = v.Capacity();
+        try {
+            v.Reserve((std::numeric_limits<size_t>::max() >> 3) + 1);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        assert(v.Capacity() == capacity && v[SIZE / 2 - 1] == (SIZE / 2 - 1) * (SIZE / 2 - 1));
+    }
+    try {
+        MappedVector<uint32_t> wrong_type(path);
+        assert(false && "Exception is expected");
+    } catch (const std::runtime_error&) {
+    }
+    ::unlink(path.c_str());
+}
+
+void Test13() {
+    const size_t SIZE = 1000;
+    {
+        Vector<double> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i] = static_cast<double>(i) / 3;
+        }
+        BufferWriter writer;
+        Serialize(v, writer);
+        assert(writer.Size() == 64 + SIZE * sizeof(double));
+
+        const auto view = VectorView<double>::Load(writer.Data(), writer.Size());
+        assert(view.Size() == SIZE);
+        // Элементы читаются прямо из буфера, без копирования
+        assert(static_cast<const void*>(view.Data()) == writer.Data() + 64);
+        assert(std::equal(view.begin(), view.end(), v.begin(), v.end()));
+
+        try {
+            VectorView<int64_t>::Load(writer.Data(), writer.Size());
+            assert(false && "Exception is expected");
+        } catch (const SerializationError&) {
+        }
+        try {
+            VectorView<double>::Load(writer.Data(), writer.Size() - 1);
+            assert(false && "Exception is expected");
+        } catch (const SerializationError&) {
+        }
+        writer.Data()[100] ^= 1;
+        try {
+            VectorView<double>::Load(writer.Data(), writer.Size());
+            assert(false && "Exception is expected");
+        } catch (const SerializationError&) {
+        }
+        // Проверку контрольной суммы можно пропустить ради скорости загрузки
+        assert(VectorView<double>::Load(writer.Data(), writer.Size(), false).Size() == SIZE);
+    }
+    // Подделанное количество элементов: count * sizeof(double) переполняется до размера нагрузки
+    {
+        Vector<double> v(1);
+        v[0] = 1.5;
+        BufferWriter writer;
+        Serialize(v, writer);
+        vector_serialize::Header header;
+        std::memcpy(&header, writer.Data(), sizeof(header));
+        header.count = (uint64_t{1} << 61) + 1;
+        std::memcpy(writer.Data(), &header, sizeof(header));
+        // Контрольная сумма покрывает заголовок, а без неё ловит проверка размера
+        for (const bool verify_checksum : {true, false}) {
+            try {
+                VectorView<double>::Load(writer.Data(), writer.Size(), verify_checksum);
+                assert(false && "Exception is expected");
+            } catch (const SerializationError&) {
+            }
+        }
+    }
+    {
+        BufferWriter writer;
+        Serialize(Vector<int>{}, writer);
+        assert(VectorView<int>::Load(writer.Data(), writer.Size()).Size() == 0);
+    }
+    {
+        Vector<Vector<uint16_t>> rows(SIZE / 10);
+        for (size_t i = 0; i < rows.Size(); ++i) {
+            for (size_t j = 0; j < i % 7; ++j) {
+                rows[i].PushBack(static_cast<uint16_t>(i * 10 + j));
+            }
+        }
+        BufferWriter writer;
+        Serialize(rows, writer);
+
+        const auto view = VectorView<Vector<uint16_t>>::Load(writer.Data(), writer.Size());
+        assert(view.Size() == rows.Size());
+        size_t total = 0;
+        for (size_t i = 0; i < rows.Size(); ++i) {
+            const VectorView<uint16_t> row = view[i];
+            assert(std::equal(row.begin(), row.end(), rows[i].begin(), rows[i].end()));
+            total += row.Size();
+        }
+        assert(view.Values().Size() == total);
+        assert(reinterpret_cast<uintptr_t>(view.Values().Data()) % 64 == reinterpret_cast<uintptr_t>(writer.Data()) % 64);
+
+        try {
+            VectorView<uint16_t>::Load(writer.Data(), writer.Size());
+            assert(false && "Exception is expected");
+        } catch (const SerializationError&) {
+        }
+        Vector<Vector<uint16_t>> empty;
+        BufferWriter empty_writer;
+        Serialize(empty, empty_writer);
+        assert(VectorView<Vector<uint16_t>>::Load(empty_writer.Data(), empty_writer.Size()).Size() == 0);
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 1000;
+    {
+        auto writer = SharedVector<uint64_t>::CreateAnonymous();
+        auto reader = SharedVector<uint64_t>::OpenFd(writer.Fd());
+        assert(writer.IsWriter() && !reader.IsWriter());
+        assert(reader.Snapshot().Size() == 0);
+
+        for (size_t i = 0; i < SIZE; ++i) {
+            writer.PushBack(i);
+        }
+        assert(writer.Generation() == SIZE);
+        // Читатель видит рост сегмента и переотображает его
+        const uint64_t sum = reader.Read([](const uint64_t* data, size_t size) {
+            uint64_t s = 0;
+            for (size_t i = 0; i < size; ++i) {
+                s += data[i];
+            }
+            return s;
+        });
+        assert(sum == SIZE * (SIZE - 1) / 2);
+        assert(reader.Size() == SIZE);
+
+        writer.Set(10, 42);
+        writer.Update([](uint64_t* data, size_t size) {
+            data[size - 1] = 7;
+        });
+        writer.PopBack();
+        const Vector<uint64_t> snapshot = reader.Snapshot();
+        assert(snapshot.Size() == SIZE - 1);
+        assert(snapshot[10] == 42);
+
+        const uint64_t values[] = {3, 2, 1};
+        writer.Assign(values, 3);
+        assert(reader.Snapshot().Size() == 3 && reader.Snapshot()[0] == 3);
+    }
+    {
+        // Читатель в другом процессе открывает сегмент по имени
+        const std::string name = "/vec_shared_test_" + std::to_string(::getpid());
+        SharedVector<uint64_t>::Unlink(name);
+        auto writer = SharedVector<uint64_t>::Create(name, SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            writer.PushBack(i * 2);
+        }
+        const pid_t child = ::fork();
+        if (child == 0) {
+            int status = 1;
+            try {
+                auto reader = SharedVector<uint64_t>::Open(name);
+                const Vector<uint64_t> snapshot = reader.Snapshot();
+                status = snapshot.Size() == SIZE && snapshot[SIZE - 1] == (SIZE - 1) * 2 ? 0 : 1;
+            } catch (...) {
+            }
+            ::_exit(status);
+        }
+        int status = 0;
+        ::waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        try {
+            SharedVector<uint32_t>::Open(name);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        SharedVector<uint64_t>::Unlink(name);
+
+        // Сегмент, который не удалось отобразить, не оставляет имя занятым
+        try {
+            SharedVector<uint64_t>::Create(name, size_t(1) << 58);
+            assert(false && "Exception is expected");
+        } catch (const std::system_error&) {
+        }
+        SharedVector<uint64_t>::Create(name, SIZE);
+        SharedVector<uint64_t>::Unlink(name);
+    }
+}
+
 struct C {
     C() noexcept {
         ++def_ctor;
@@ -639,6 +1327,1324 @@ void Benchmark() {
     }
 }
 
+void Test15() {
+    const std::string path = "/tmp/vec_stream_test_" + std::to_string(::getpid());
+    const size_t CHUNK = 1000;
+    const size_t SIZE = CHUNK * 7 + 123;
+    {
+        VectorStreamWriter<uint32_t> writer(path, CHUNK);
+        Vector<uint32_t> batch(CHUNK * 2 + 17);
+        size_t next = 0;
+        for (auto& x : batch) {
+            x = static_cast<uint32_t>(next++);
+        }
+        writer.Append(batch);
+        while (next < SIZE) {
+            writer.PushBack(static_cast<uint32_t>(next++));
+        }
+        assert(writer.Size() == SIZE);
+        writer.Close();
+    }
+    {
+        VectorStreamReader<uint32_t> reader(path, CHUNK);
+        size_t total = 0;
+        const uint32_t* buffers[2] = {nullptr, nullptr};
+        size_t chunk_index = 0;
+        while (reader.Next()) {
+            const Vector<uint32_t>& chunk = reader.Chunk();
+            assert(chunk.Size() == CHUNK || total + chunk.Size() == SIZE);
+            for (size_t i = 0; i < chunk.Size(); ++i) {
+                assert(chunk[i] == total + i);
+            }
+            // Куски поочерёдно попадают в одни и те же два буфера
+            if (chunk_index < 2) {
+                buffers[chunk_index] = chunk.begin();
+            } else {
+                assert(chunk.begin() == buffers[chunk_index % 2]);
+            }
+            ++chunk_index;
+            total += chunk.Size();
+        }
+        assert(total == SIZE);
+        assert(!reader.Next());
+    }
+    {
+        // Неполный элемент в конце файла
+        VectorStreamWriter<char> writer(path, 16);
+        writer.Append("12345", 5);
+    }
+    try {
+        VectorStreamReader<uint32_t> reader(path, CHUNK);
+        reader.Next();
+        assert(false && "Exception is expected");
+    } catch (const std::runtime_error&) {
+    }
+    ::unlink(path.c_str());
+}
+
+template <typename T, PackedEncoding Encoding>
+void CheckPacked(const Vector<T>& values) {
+    PackedIntVector<T, Encoding> packed(values);
+    assert(packed.Size() == values.Size());
+    for (size_t i = 0; i < values.Size(); ++i) {
+        assert(packed[i] == values[i]);
+    }
+    Vector<T> decoded;
+    packed.DecodeTo(decoded);
+    assert(decoded.Size() == values.Size());
+    assert(std::equal(decoded.begin(), decoded.end(), values.begin()));
+
+    // Поэлементное добавление даёт то же, что и пакетное
+    PackedIntVector<T, Encoding> appended;
+    for (size_t i = 0; i < values.Size(); ++i) {
+        appended.PushBack(values[i]);
+    }
+    assert(appended.MemoryUsage() == packed.MemoryUsage());
+    T block[PackedIntVector<T, Encoding>::kBlockSize];
+    size_t index = 0;
+    for (size_t b = 0; b < appended.BlockCount(); ++b) {
+        const size_t n = appended.DecodeBlock(b, block);
+        for (size_t i = 0; i < n; ++i, ++index) {
+            assert(block[i] == values[index]);
+        }
+    }
+    assert(index == values.Size());
+}
+
+void Test16() {
+    const size_t SIZE = 10'000;
+    std::mt19937_64 random(16);
+
+    // Возрастающий список документов с небольшими промежутками
+    Vector<uint32_t> postings;
+    uint32_t doc = 1'000'000;
+    for (size_t i = 0; i < SIZE; ++i) {
+        doc += 1 + random() % 16;
+        postings.PushBack(doc);
+    }
+    CheckPacked<uint32_t, PackedEncoding::Delta>(postings);
+    CheckPacked<uint32_t, PackedEncoding::FrameOfReference>(postings);
+    {
+        PackedIntVector<uint32_t, PackedEncoding::Delta> packed(postings);
+        assert(packed.MemoryUsage() * 4 <= postings.Size() * sizeof(uint32_t));
+    }
+
+    // Отметки времени в наносекундах с шагом около миллисекунды
+    Vector<uint64_t> timestamps;
+    uint64_t now = 1'700'000'000'000'000'000ull;
+    for (size_t i = 0; i < SIZE; ++i) {
+        now += 1'000'000 + random() % 1000;
+        timestamps.PushBack(now);
+    }
+    CheckPacked<uint64_t, PackedEncoding::Delta>(timestamps);
+    {
+        PackedIntVector<uint64_t, PackedEncoding::Delta> packed(timestamps);
+        assert(packed.MemoryUsage() * 2 <= timestamps.Size() * sizeof(uint64_t));
+    }
+
+    // Узкий диапазон в произвольном порядке, полная ширина, нулевая ширина и короткий хвост
+    Vector<uint32_t> small;
+    Vector<uint64_t> full;
+    for (size_t i = 0; i < SIZE + 77; ++i) {
+        small.PushBack(static_cast<uint32_t>(100 + random() % 200));
+        full.PushBack(random());
+    }
+    CheckPacked<uint32_t, PackedEncoding::FrameOfReference>(small);
+    CheckPacked<uint32_t, PackedEncoding::Delta>(small);
+    CheckPacked<uint64_t, PackedEncoding::FrameOfReference>(full);
+    CheckPacked<uint64_t, PackedEncoding::Delta>(full);
+    CheckPacked<uint16_t, PackedEncoding::FrameOfReference>(Vector<uint16_t>(SIZE));
+    CheckPacked<uint8_t, PackedEncoding::Delta>(Vector<uint8_t>(5));
+    CheckPacked<uint32_t, PackedEncoding::Delta>(Vector<uint32_t>());
+}
+
+void Test17() {
+    const size_t SIZE = 5'000;
+    std::mt19937_64 random(17);
+    std::vector<bool> expected_a;
+    std::vector<bool> expected_b;
+    BitVector a;
+    BitVector b(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        const bool x = random() % 3 == 0;
+        const bool y = random() % 2 == 0;
+        a.PushBack(x);
+        b.Set(i, y);
+        expected_a.push_back(x);
+        expected_b.push_back(y);
+    }
+    assert(a.Size() == SIZE && b.Size() == SIZE);
+    assert(a.Capacity() >= SIZE);
+    assert(a.Count() == static_cast<size_t>(std::count(expected_a.begin(), expected_a.end(), true)));
+
+    auto check = [](const BitVector& bits, auto op, const std::vector<bool>& x, const std::vector<bool>& y) {
+        assert(bits.Size() == x.size());
+        size_t ones = 0;
+        for (size_t i = 0; i < x.size(); ++i) {
+            assert(bits[i] == op(x[i], y[i]));
+            ones += bits[i];
+        }
+        assert(bits.Count() == ones);
+    };
+    check(a & b, [](bool x, bool y) { return x && y; }, expected_a, expected_b);
+    check(a | b, [](bool x, bool y) { return x || y; }, expected_a, expected_b);
+    check(a ^ b, [](bool x, bool y) { return x != y; }, expected_a, expected_b);
+    check(BitVector(a).AndNot(b), [](bool x, bool y) { return x && !y; }, expected_a, expected_b);
+    {
+        BitVector c(a);
+        c ^= a;
+        assert(!c.Any());
+        assert(c != a);
+        c = a;
+        assert(c == a);
+    }
+
+    // Хвост последнего слова остаётся нулевым
+    {
+        BitVector ones(100, true);
+        assert(ones.Count() == 100);
+        ones.Resize(70);
+        assert(ones.Count() == 70);
+        ones.Resize(130, true);
+        assert(ones.Count() == 130);
+        ones.Resize(200);
+        assert(ones.Count() == 130);
+        ones.Flip(199);
+        ones.Reset(0);
+        ones.PopBack();
+        assert(ones.Count() == 129);
+        assert(!ones[0] && ones[1] && !ones[198]);
+    }
+
+    // Rank и Select на разреженном и плотном векторах, включая границы блоков
+    for (const size_t size : {size_t{0}, size_t{64}, size_t{512}, size_t{4096}, size_t{10'001}}) {
+        for (const unsigned density : {2u, 50u}) {
+            BitVector bits(size);
+            for (size_t i = 0; i < size; ++i) {
+                bits.Set(i, random() % density == 0);
+            }
+            const BitVectorRank rank(bits);
+            assert(rank.Ones() == bits.Count());
+            size_t ones = 0;
+            for (size_t i = 0; i < size; ++i) {
+                assert(rank.Rank(i) == ones);
+                if (bits[i]) {
+                    assert(rank.Select(ones) == i);
+                    ++ones;
+                }
+            }
+            assert(rank.Rank(size) == ones);
+            assert(rank.Select(ones) == size);
+
+            size_t visited = 0;
+            bits.ForEachSetBit([&](size_t index) {
+                assert(rank.Select(visited++) == index);
+            });
+            assert(visited == ones);
+        }
+    }
+}
+
+void Test18() {
+    std::mt19937_64 random(18);
+    for (const FlatLayout layout : {FlatLayout::Sorted, FlatLayout::Eytzinger}) {
+        // Построение из неотсортированных пар: из повторов остаётся первая
+        Vector<std::pair<int, int>> items;
+        std::map<int, int> expected;
+        for (int i = 0; i < 1000; ++i) {
+            const int key = static_cast<int>(random() % 600) * 2;
+            items.PushBack({key, i});
+            expected.emplace(key, i);
+        }
+        FlatMap<int, int> map(items);
+        map.SetLayout(layout);
+        assert(map.Layout() == layout);
+
+        auto check = [&] {
+            assert(map.Size() == expected.size());
+            size_t index = 0;
+            for (const auto& [key, value] : expected) {
+                assert(map.KeyAt(index) == key && map.ValueAt(index) == value);
+                ++index;
+            }
+            for (int key = -3; key < 1300; ++key) {
+                const auto it = expected.lower_bound(key);
+                assert(map.LowerBound(key) == static_cast<size_t>(std::distance(expected.begin(), it)));
+                const int* value = map.Find(key);
+                assert((value != nullptr) == (it != expected.end() && it->first == key));
+                assert(value == nullptr || *value == it->second);
+            }
+        };
+        check();
+
+        for (int i = 0; i < 300; ++i) {
+            const int key = static_cast<int>(random() % 1300);
+            switch (random() % 4) {
+            case 0:
+                assert(map.Insert(key, -i).second == expected.emplace(key, -i).second);
+                break;
+            case 1:
+                assert(map.Erase(key) == (expected.erase(key) == 1));
+                break;
+            case 2:
+                map.InsertOrAssign(key, i);
+                expected[key] = i;
+                break;
+            default:
+                map[key] += 1;
+                expected[key] += 1;
+                break;
+            }
+        }
+        check();
+
+        // Пачка сливается за один проход, имеющиеся ключи не перезаписываются
+        Vector<std::pair<int, int>> batch;
+        for (int i = 0; i < 500; ++i) {
+            const int key = static_cast<int>(random() % 1300);
+            batch.PushBack({key, 10'000 + i});
+            expected.emplace(key, 10'000 + i);
+        }
+        map.InsertBatch(std::move(batch));
+        check();
+    }
+
+    {
+        Vector<std::string> words;
+        for (const char* word : {"pear", "apple", "fig", "apple", "kiwi", "fig"}) {
+            words.PushBack(word);
+        }
+        FlatSet<std::string> set(words);
+        assert(set.Size() == 4);
+        assert(std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains("kiwi") && !set.Contains("plum"));
+        set.SetLayout(FlatLayout::Eytzinger);
+        assert(set.Insert("plum") && !set.Insert("pear"));
+        assert(set.Contains("plum"));
+        assert(set.Erase("apple") && !set.Erase("apple"));
+
+        Vector<std::string> more;
+        more.PushBack("zucchini");
+        more.PushBack("banana");
+        more.PushBack("fig");
+        set.InsertBatch(std::move(more));
+        const std::set<std::string> expected{"banana", "fig", "kiwi", "pear", "plum", "zucchini"};
+        assert(std::equal(set.begin(), set.end(), expected.begin(), expected.end()));
+        for (const auto& word : expected) {
+            assert(set.Contains(word));
+        }
+        assert(!set.Contains("apple") && set.LowerBound("a") == 0 && set.LowerBound("zz") == set.Size());
+    }
+    {
+        // Исключение при вставке оставляет словарь прежним
+        static int copies_before_throw = -1;
+        struct Fragile {
+            Fragile(int value = 0)
+                : value(value)  //
+            {
+            }
+            Fragile(const Fragile& other)
+                : value(other.value)  //
+            {
+                Tick();
+            }
+            Fragile(Fragile&& other)
+                : value(other.value)  //
+            {
+                Tick();
+                other.value = -1;
+            }
+            Fragile& operator=(const Fragile&) = default;
+            Fragile& operator=(Fragile&&) = default;
+            static void Tick() {
+                if (copies_before_throw >= 0 && copies_before_throw-- == 0) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+            int value;
+        };
+        for (const FlatLayout layout : {FlatLayout::Sorted, FlatLayout::Eytzinger}) {
+            FlatMap<int, Fragile> map;
+            map.SetLayout(layout);
+            for (int key = 0; key < 10; ++key) {
+                map.Insert(key * 2, Fragile(key * 20));
+            }
+            const auto check = [&map] {
+                assert(map.Size() == 10);
+                for (int key = 0; key < 10; ++key) {
+                    const Fragile* value = map.Find(key * 2);
+                    assert(value != nullptr && value->value == key * 20);
+                    assert(map.Find(key * 2 + 1) == nullptr);
+                }
+            };
+
+            copies_before_throw = 0;
+            try {
+                map.Insert(5, Fragile(50));
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            copies_before_throw = -1;
+            check();
+
+            // Пачка: исключение на каждом из шагов слияния по очереди
+            Vector<std::pair<int, Fragile>> batch;
+            for (int key = 0; key < 5; ++key) {
+                batch.PushBack({key * 4 + 1, Fragile(key)});
+            }
+            for (int countdown = 0;; ++countdown) {
+                Vector<std::pair<int, Fragile>> items(batch);
+                copies_before_throw = countdown;
+                try {
+                    map.InsertBatch(std::move(items));
+                    copies_before_throw = -1;
+                    break;
+                } catch (const std::runtime_error&) {
+                    copies_before_throw = -1;
+                    check();
+                }
+            }
+            assert(map.Size() == 15 && map.Find(17)->value == 4 && map.Find(18)->value == 180);
+        }
+    }
+}
+
+void Test19() {
+    std::mt19937_64 random(19);
+    {
+        FlatHashMap<uint64_t, uint64_t> map;
+        std::unordered_map<uint64_t, uint64_t> expected;
+        // Узкий диапазон ключей: много повторных вставок и удалений, а значит и меток удалённых
+        for (uint64_t i = 0; i < 200'000; ++i) {
+            const uint64_t key = random() % 3000;
+            switch (random() % 3) {
+            case 0:
+                assert(map.Insert(key, i).second == expected.emplace(key, i).second);
+                break;
+            case 1:
+                assert(map.Erase(key) == (expected.erase(key) == 1));
+                break;
+            default:
+                map[key] += i;
+                expected[key] += i;
+                break;
+            }
+        }
+        assert(map.Size() == expected.size());
+        // Несмотря на метки, таблица не растёт сверх нужного
+        assert(map.Capacity() <= 8192);
+        for (uint64_t key = 0; key < 3000; ++key) {
+            const auto it = expected.find(key);
+            const uint64_t* value = map.Find(key);
+            assert((value != nullptr) == (it != expected.end()));
+            assert(value == nullptr || *value == it->second);
+        }
+        size_t visited = 0;
+        map.ForEach([&](uint64_t key, uint64_t& value) {
+            assert(expected.at(key) == value);
+            ++visited;
+        });
+        assert(visited == expected.size());
+
+        FlatHashMap<uint64_t, uint64_t> copy(map);
+        map.Clear();
+        assert(map.Size() == 0 && !map.Contains(expected.begin()->first));
+        assert(copy.Size() == expected.size());
+        map = std::move(copy);
+        assert(map.Size() == expected.size() && *map.Find(expected.begin()->first) == expected.begin()->second);
+    }
+    {
+        // Reserve перестраивает таблицу один раз, дальше вставки её не трогают
+        FlatHashMap<int, int> map;
+        map.Reserve(1000);
+        const size_t capacity = map.Capacity();
+        assert(capacity >= 1000);
+        for (int i = 0; i < 1000; ++i) {
+            map.Insert(i * 7919, i);
+        }
+        assert(map.Capacity() == capacity);
+        for (int i = 0; i < 1000; ++i) {
+            assert(*map.Find(i * 7919) == i);
+        }
+        assert(!map.Contains(-1));
+    }
+    {
+        // Поиск строк по string_view и литералу без временной std::string
+        FlatHashMap<std::string, std::string> map;
+        for (int i = 0; i < 100; ++i) {
+            map.InsertOrAssign("key" + std::to_string(i), std::to_string(i));
+        }
+        map.InsertOrAssign("key7", "seven");
+        assert(map.Size() == 100);
+        const std::string_view view = "key42";
+        assert(map.Contains(view) && *map.Find(view) == "42");
+        assert(*map.Find("key7") == "seven");
+        assert(map.Find("nope") == nullptr);
+        assert(map.Erase("key7") && !map.Contains(std::string("key7")));
+        auto [value, inserted] = map.TryEmplace("fresh", 3, 'x');
+        assert(inserted && *value == "xxx");
+    }
+    {
+        // Исключение из конструктора значения не занимает ячейку, а из копирования
+        // при перестройке — оставляет таблицу прежней
+        static int copies_before_throw = -1;
+        struct Fragile {
+            explicit Fragile(int value)
+                : value(value)  //
+            {
+                if (value < 0) {
+                    throw std::runtime_error("Negative");
+                }
+            }
+            Fragile(const Fragile& other)
+                : value(other.value)  //
+            {
+                Tick();
+            }
+            Fragile(Fragile&& other)
+                : value(other.value)  //
+            {
+                Tick();
+                other.value = -1;
+            }
+            static void Tick() {
+                if (copies_before_throw >= 0 && copies_before_throw-- == 0) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+            int value;
+        };
+        FlatHashMap<int, Fragile> map;
+        map.Reserve(7);
+        const size_t capacity = map.Capacity();
+        const size_t max_load = capacity - capacity / 8;
+        for (size_t i = 0; i < max_load / 2; ++i) {
+            map.TryEmplace(static_cast<int>(i), static_cast<int>(i));
+        }
+        const Fragile* first = map.Find(0);
+        for (size_t i = 0; i < max_load; ++i) {
+            try {
+                map.TryEmplace(1000 + static_cast<int>(i), -1);
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+        }
+        // Неудачные вставки не израсходовали запас: таблица не перестраивалась
+        for (size_t i = max_load / 2; i < max_load; ++i) {
+            map.TryEmplace(static_cast<int>(i), static_cast<int>(i));
+        }
+        assert(map.Size() == max_load && map.Capacity() == capacity && map.Find(0) == first);
+
+        copies_before_throw = static_cast<int>(max_load / 2);
+        try {
+            map.TryEmplace(-1, 1);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        copies_before_throw = -1;
+        assert(map.Size() == max_load && map.Capacity() == capacity && map.Find(0) == first);
+        for (size_t i = 0; i < max_load; ++i) {
+            assert(map.Find(static_cast<int>(i))->value == static_cast<int>(i));
+        }
+        map.TryEmplace(-1, 1);
+        assert(map.Size() == max_load + 1 && map.Capacity() > capacity && map.Find(-1)->value == 1);
+    }
+}
+
+void Test20() {
+    std::mt19937_64 random(20);
+    SlotMap<std::string> map;
+    std::vector<std::pair<SlotMapHandle, std::string>> alive;
+    std::vector<SlotMapHandle> dead;
+    for (int i = 0; i < 20'000; ++i) {
+        if (alive.empty() || random() % 3 != 0) {
+            std::string value = "entity" + std::to_string(i);
+            const SlotMapHandle handle = map.Insert(value);
+            alive.emplace_back(handle, std::move(value));
+        } else {
+            const size_t victim = random() % alive.size();
+            assert(map.Erase(alive[victim].first));
+            assert(!map.Erase(alive[victim].first));
+            dead.push_back(alive[victim].first);
+            alive[victim] = std::move(alive.back());
+            alive.pop_back();
+        }
+    }
+    assert(map.Size() == alive.size());
+    // Ссылки пережили и перевыделения, и перестановки при удалении
+    for (const auto& [handle, value] : alive) {
+        assert(map.Contains(handle));
+        assert(*map.Get(handle) == value && map[handle] == value);
+    }
+    // Ссылки на удалённые не совпадают с элементами, занявшими их ячейки
+    for (const SlotMapHandle handle : dead) {
+        assert(!map.Contains(handle) && map.Get(handle) == nullptr);
+    }
+    assert(!map.Contains(SlotMapHandle{}));
+
+    // Плотный перебор видит каждый живой элемент один раз, HandleAt ведёт обратно к нему
+    size_t dense = 0;
+    for (const std::string& value : map) {
+        const SlotMapHandle handle = map.HandleAt(dense++);
+        assert(&map[handle] == &value);
+    }
+    assert(dense == alive.size());
+
+    map.Clear();
+    assert(map.Empty());
+    for (const auto& [handle, value] : alive) {
+        assert(!map.Contains(handle));
+    }
+    const SlotMapHandle reused = map.Insert("again");
+    assert(map.Size() == 1 && map[reused] == "again");
+}
+
+void Test21() {
+    std::mt19937_64 random(21);
+    {
+        HeapVector<int> heap;
+        std::priority_queue<int> expected;
+        for (int round = 0; round < 200; ++round) {
+            switch (random() % 4) {
+            case 0: {
+                // Маленькая пачка вставляется по одному, большая — перестройкой кучи
+                Vector<int> batch;
+                const size_t count = random() % 2 == 0 ? random() % 4 : random() % 500;
+                for (size_t i = 0; i < count; ++i) {
+                    batch.PushBack(static_cast<int>(random() % 1000));
+                    expected.push(batch[i]);
+                }
+                heap.PushBatch(std::move(batch));
+                break;
+            }
+            case 1: {
+                Vector<int> popped;
+                const size_t n = random() % 50;
+                assert(heap.PopN(n, popped) == std::min(n, expected.size()));
+                for (const int x : popped) {
+                    assert(x == expected.top());
+                    expected.pop();
+                }
+                break;
+            }
+            case 2:
+                if (!heap.Empty()) {
+                    const int x = static_cast<int>(random() % 1000);
+                    heap.ReplaceTop(x);
+                    expected.pop();
+                    expected.push(x);
+                }
+                break;
+            default: {
+                const int x = static_cast<int>(random() % 1000);
+                heap.Push(x);
+                expected.push(x);
+                break;
+            }
+            }
+            assert(heap.Size() == expected.size());
+            assert(heap.Empty() || heap.Top() == expected.top());
+        }
+        while (!heap.Empty()) {
+            assert(heap.Pop() == expected.top());
+            expected.pop();
+        }
+    }
+    {
+        // Отбор 10 наибольших: куча с обратным сравнением хранит лучших, вершина — худший из них
+        Vector<uint64_t> values;
+        for (int i = 0; i < 10'000; ++i) {
+            values.PushBack(random() % 1'000'000);
+        }
+        HeapVector<uint64_t, std::greater<uint64_t>> top;
+        for (const uint64_t x : values) {
+            if (top.Size() < 10) {
+                top.Push(x);
+            } else if (x > top.Top()) {
+                top.ReplaceTop(x);
+            }
+        }
+        std::vector<uint64_t> sorted(values.begin(), values.end());
+        std::sort(sorted.begin(), sorted.end(), std::greater<uint64_t>());
+        Vector<uint64_t> best;
+        top.PopN(10, best);
+        for (size_t i = 0; i < 10; ++i) {
+            assert(best[i] == sorted[9 - i]);
+        }
+    }
+    {
+        // Дейкстра на случайном графе против Беллмана — Форда
+        const size_t N = 300;
+        std::vector<std::vector<std::pair<size_t, uint32_t>>> edges(N);
+        for (size_t i = 0; i < N * 5; ++i) {
+            edges[random() % N].emplace_back(random() % N, static_cast<uint32_t>(random() % 100));
+        }
+        const uint32_t INF = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> dist(N, INF);
+        IndexedHeapVector<uint32_t, std::greater<uint32_t>> queue;
+        dist[0] = 0;
+        queue.Push(0, 0);
+        while (!queue.Empty()) {
+            const auto [v, d] = queue.Pop();
+            for (const auto& [to, w] : edges[v]) {
+                if (d + w < dist[to]) {
+                    if (queue.Contains(to)) {
+                        queue.DecreaseKey(to, d + w);
+                    } else {
+                        queue.Push(to, d + w);
+                    }
+                    dist[to] = d + w;
+                    assert(queue.Get(to) == dist[to]);
+                }
+            }
+        }
+        std::vector<uint32_t> expected(N, INF);
+        expected[0] = 0;
+        for (size_t round = 0; round < N; ++round) {
+            for (size_t v = 0; v < N; ++v) {
+                for (const auto& [to, w] : edges[v]) {
+                    if (expected[v] != INF && expected[v] + w < expected[to]) {
+                        expected[to] = expected[v] + w;
+                    }
+                }
+            }
+        }
+        assert(dist == expected);
+    }
+    {
+        IndexedHeapVector<int> heap;
+        std::map<size_t, int> expected;
+        for (size_t id = 0; id < 500; ++id) {
+            const int x = static_cast<int>(random() % 1000);
+            heap.Push(id, x);
+            expected[id] = x;
+        }
+        for (int i = 0; i < 1000; ++i) {
+            const size_t id = random() % 500;
+            if (random() % 2 == 0) {
+                assert(heap.Erase(id) == (expected.erase(id) == 1));
+            } else if (heap.Contains(id)) {
+                const int x = static_cast<int>(random() % 1000);
+                heap.Update(id, x);
+                expected[id] = x;
+            }
+        }
+        assert(heap.Size() == expected.size());
+        int previous = std::numeric_limits<int>::max();
+        while (!heap.Empty()) {
+            const auto [id, value] = heap.Pop();
+            assert(expected.at(id) == value && value <= previous);
+            previous = value;
+        }
+    }
+}
+
+void Test22() {
+#ifndef VECTOR_ENABLE_STATS
+    // Выключенная статистика не меняет размер вектора
+    static_assert(!vector_stats::kEnabled);
+    static_assert(vector_record::kEnabled || sizeof(Vector<int>) == sizeof(void*) + 2 * sizeof(size_t));
+    Vector<int> v;
+    v.Reserve(10);
+    v.PushBack(1);
+    const VectorStats stats = v.Stats();
+    assert(stats.reallocations == 0 && stats.bytes_allocated == 0);
+    assert(stats.wasted_bytes == 9 * sizeof(int));
+#else
+    const auto site_reallocations = [](const char* tag) {
+        uint64_t result = 0;
+        vector_stats::Registry::Instance().ForEachSite([&](const vector_stats::Site& site) {
+            if (site.tag == tag) {
+                result = site.reallocations.load();
+            }
+        });
+        return result;
+    };
+    {
+        VectorStatsScope scope("test22-growth");
+        Vector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        // 1, 2, 4, ..., 128: восемь выделений, перенесено 1 + 2 + ... + 64 элементов
+        VectorStats stats = v.Stats();
+        assert(stats.reallocations == 8);
+        assert(stats.bytes_allocated == 255 * sizeof(int));
+        assert(stats.bytes_relocated == 127 * sizeof(int));
+        assert(stats.peak_capacity_bytes == 128 * sizeof(int));
+        assert(stats.wasted_bytes == 28 * sizeof(int));
+        assert(stats.first_growth_ns != 0 && stats.first_growth_ns <= stats.last_growth_ns);
+
+        v.Reserve(1000);
+        v.EmplaceBack(1);
+        v.Insert(v.begin(), 2);
+        assert(v.Stats().reallocations == 9);
+
+        // Копия начинает свои счётчики с нуля
+        Vector<int> copy(v);
+        assert(copy.Stats().reallocations == 0);
+        assert(site_reallocations("test22-growth") == 9);
+    }
+    {
+        VectorStatsScope outer("test22-outer");
+        {
+            VectorStatsScope inner("test22-inner");
+            Vector<std::string> strings;
+            strings.Resize(3);
+        }
+        Vector<int> v;
+        v.PushBack(1);
+        assert(site_reallocations("test22-inner") == 1);
+        assert(site_reallocations("test22-outer") == 1);
+    }
+    {
+        // Вектор вне областей приписывается статическому месту «unscoped», которое тоже выгружается
+        Vector<int> v;
+        v.PushBack(1);
+        assert(site_reallocations("unscoped") >= 1);
+    }
+    std::ostringstream out;
+    vector_stats::DumpJson(out);
+    const std::string json = out.str();
+    assert(json.front() == '[' && json.find("\"tag\": \"test22-growth\"") != std::string::npos);
+    assert(json.find("\"live_instances\": 0") != std::string::npos);
+    assert(json.find("\"tag\": \"unscoped\"") != std::string::npos);
+#endif
+}
+
+// Трассировка проверяется только в сборке с VECTOR_ENABLE_TRACING
+void Test23() {
+#ifdef VECTOR_ENABLE_TRACING
+    static std::atomic<int> slow_calls{0};
+    static std::atomic<int> all_calls{0};
+    const auto count_records = [](const char* tag) {
+        size_t result = 0;
+        vector_trace::ForEachRecord([&](uint32_t, const vector_trace::GrowthRecord& record) {
+            result += std::string_view(record.tag) == tag;
+        });
+        return result;
+    };
+    {
+        VectorStatsScope scope("test23-main");
+        vector_trace::SetCallback(+[](const vector_trace::GrowthRecord&) { ++all_calls; });
+        Vector<double> v;
+        for (int i = 0; i < 16; ++i) {
+            v.PushBack(i);
+        }
+        v.Reserve(100);
+        // 1, 2, 4, 8, 16 и Reserve
+        assert(all_calls == 6);
+        assert(count_records("test23-main") == 6);
+
+        bool found = false;
+        vector_trace::ForEachRecord([&](uint32_t, const vector_trace::GrowthRecord& record) {
+            if (std::string_view(record.tag) == "test23-main" && record.new_capacity == 100) {
+                assert(record.old_capacity == 16 && record.element_size == sizeof(double));
+                assert(std::string_view(record.type_name) == "double");
+                found = true;
+            }
+        });
+        assert(found);
+
+        // Порог отсекает быстрые перевыделения
+        vector_trace::SetCallback(+[](const vector_trace::GrowthRecord&) { ++slow_calls; },
+                                  std::numeric_limits<uint64_t>::max());
+        v.Reserve(1000);
+        assert(slow_calls == 0);
+        vector_trace::SetCallback(nullptr);
+    }
+    {
+        // Кольцо хранит последние kRingSize записей потока по порядку
+        std::thread writer([] {
+            VectorStatsScope scope("test23-ring");
+            for (size_t i = 0; i < vector_trace::kRingSize + 10; ++i) {
+                Vector<int> v;
+                v.Reserve(i + 1);
+            }
+        });
+        writer.join();
+        uint64_t previous = 0;
+        size_t count = 0;
+        vector_trace::ForEachRecord([&](uint32_t, const vector_trace::GrowthRecord& record) {
+            if (std::string_view(record.tag) == "test23-ring") {
+                assert(record.new_capacity > previous);
+                previous = record.new_capacity;
+                ++count;
+            }
+        });
+        assert(count == vector_trace::kRingSize && previous == vector_trace::kRingSize + 10);
+    }
+    {
+        // Кольцо завершившегося потока переходит к новому
+        const auto ring_count = [] {
+            size_t rings = 0;
+            vector_trace::RingList::Instance().ForEach([&](const vector_trace::Ring&) { ++rings; });
+            return rings;
+        };
+        const size_t rings = ring_count();
+        std::thread reuse([] {
+            Vector<int> v;
+            v.PushBack(1);
+        });
+        reuse.join();
+        assert(ring_count() == rings);
+    }
+
+    uint64_t histogram_total = 0;
+    for (const auto& bucket : vector_trace::GlobalHistogram().capacity_bytes) {
+        histogram_total += bucket.load();
+    }
+    uint64_t recorded = 0;
+    vector_trace::RingList::Instance().ForEach([&](const vector_trace::Ring& ring) { recorded += ring.Recorded(); });
+    assert(histogram_total == recorded);
+
+    std::ostringstream out;
+    vector_trace::ExportChromeTrace(out);
+    const std::string json = out.str();
+    assert(json.rfind("{\"traceEvents\": [", 0) == 0);
+    assert(json.find("\"name\": \"double\", \"cat\": \"vector_growth\", \"ph\": \"X\"") != std::string::npos);
+    assert(json.find("\"tag\": \"test23-main\"") != std::string::npos);
+#endif
+}
+
+// Запись трассы проверяется только в сборке с VECTOR_ENABLE_RECORDING
+void Test24() {
+#ifdef VECTOR_ENABLE_RECORDING
+    using vector_record::Op;
+    const std::string path = "/tmp/vec_record_test_" + std::to_string(::getpid());
+    Vector<int> before;
+    before.PushBack(1);
+    before.PushBack(2);
+
+    vector_record::Start(path);
+    before.PushBack(3);
+    {
+        Vector<int> a(2);
+        a.Insert(a.begin() + 1, 7);
+        a.Erase(a.begin());
+        Vector<int> b(a);
+        b.Reserve(100);
+        b = before;
+        Vector<int> c(std::move(b));
+        c.Resize(1);
+        c.PopBack();
+        c.Swap(a);
+        before.EraseUnordered(before.begin());
+    }
+    vector_record::Stop();
+    // После остановки ничего не пишется
+    before.PushBack(4);
+
+    std::vector<vector_record::Event> events;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    assert(file != nullptr);
+    vector_record::ReadTrace(file, [&](const vector_record::Event& event) { events.push_back(event); });
+    std::fclose(file);
+    std::remove(path.c_str());
+
+    const std::vector<Op> expected = {
+        Op::Adopt, Op::EmplaceBack,                     // before: создан до Start
+        Op::Adopt, Op::Resize, Op::Emplace, Op::Erase,  // a
+        Op::CopyConstruct, Op::Reserve, Op::CopyAssign, // b
+        Op::MoveConstruct, Op::Resize, Op::PopBack,     // c
+        Op::Swap, Op::EraseUnordered,
+        Op::Destroy, Op::Destroy, Op::Destroy,          // c, b, a
+    };
+    assert(events.size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(events[i].op == expected[i]);
+    }
+    const uint64_t before_id = events[0].args[0];
+    assert(events[0].args[1] == sizeof(int) && events[0].args[2] == 2 && events[0].args[3] == 2);
+    const uint64_t a_id = events[2].args[0];
+    assert(events[3].args[0] == a_id && events[3].args[1] == 2);
+    assert(events[4].args[1] == 1 && events[5].args[1] == 0 && events[5].args[2] == 1);
+    const uint64_t b_id = events[6].args[0];
+    assert(events[6].args[1] == a_id && b_id != a_id);
+    assert(events[8].args[0] == b_id && events[8].args[1] == before_id);
+    const uint64_t c_id = events[9].args[0];
+    assert(events[9].args[1] == b_id);
+    assert(events[12].args[0] == c_id && events[12].args[1] == a_id);
+    assert(events[13].args[0] == before_id && events[13].args[1] == 0);
+    assert(events[14].args[0] == c_id && events[15].args[0] == b_id && events[16].args[0] == a_id);
+
+    // Повреждённый файл
+    file = std::tmpfile();
+    std::fputs("garbage", file);
+    std::rewind(file);
+    try {
+        vector_record::ReadTrace(file, [](const vector_record::Event&) {});
+        assert(false && "Exception is expected");
+    } catch (const std::runtime_error&) {
+    }
+    std::fclose(file);
+#endif
+}
+
+void Test25() {
+    // Перемещающее присваивание разрушает прежние элементы левого операнда
+    {
+        Obj::ResetCounters();
+        Vector<Obj> lhs;
+        lhs.EmplaceBack(1);
+        lhs.EmplaceBack(2);
+        Vector<Obj> rhs;
+        rhs.EmplaceBack(3);
+        lhs = std::move(rhs);
+        assert(lhs.Size() == 1 && lhs[0].id == 3);
+        assert(rhs.Size() == 0);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    // Вставка копии собственного элемента без перевыделения
+    {
+        Vector<std::string> v;
+        v.Reserve(8);
+        v.PushBack("a");
+        v.PushBack("b");
+        v.PushBack("c");
+        v.Insert(v.cbegin(), v[1]);
+        v.Insert(v.cbegin() + 1, std::as_const(v)[3]);
+        assert(v.Size() == 5);
+        assert(v[0] == "b" && v[1] == "c" && v[2] == "a" && v[3] == "b" && v[4] == "c");
+    }
+}
+
+void Test26() {
+    static_assert(sizeof(ThinVector<int>) == sizeof(void*));
+    static_assert(sizeof(ThinVector<std::string>) == sizeof(void*));
+    // Пустые векторы не выделяют память и делят один заголовок
+    {
+        ThinVector<int> a;
+        ThinVector<int> b(0);
+        ThinVector<int> c(a);
+        assert(a.Size() == 0 && a.Capacity() == 0 && a.begin() == a.end());
+        assert(a.begin() == b.begin() && a.begin() == c.begin());
+        c = b;
+        b.Reserve(0);
+        b.Resize(0);
+        assert(b.EraseIf([](int) { return true; }) == 0);
+        b.Erase(b.cbegin(), b.cend());
+        assert(b.Capacity() == 0);
+    }
+    // Те же операции, что у Vector, и учёт живых объектов
+    {
+        Obj::ResetCounters();
+        ThinVector<Obj> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Size() == 10 && v.Capacity() == 16);
+        v.Insert(v.cbegin(), v[9]);
+        v.Erase(v.cbegin() + 5, v.cbegin() + 7);
+        v.EraseUnordered(v.cbegin() + 1);
+        assert(v.Size() == 8);
+        const int expected[] = {9, 9, 1, 2, 3, 6, 7, 8};
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id == expected[i]);
+        }
+        assert(v.EraseIf([](const Obj& obj) { return obj.id % 3 == 0; }) == 4);
+        assert(v.Size() == 4 && v[0].id == 1 && v[1].id == 2 && v[2].id == 7 && v[3].id == 8);
+        ThinVector<Obj> copy(v);
+        ThinVector<Obj> moved(std::move(copy));
+        assert(copy.Size() == 0 && moved.Size() == 4);
+        copy = moved;
+        moved = std::move(v);
+        v.Resize(4);
+        assert(v.Size() == 4 && v[3].id == 0);
+        v.PopBack();
+        assert(Obj::GetAliveObjectCount() == 11);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    // Исключение при копировании оставляет вектор нетронутым
+    {
+        Obj::ResetCounters();
+        ThinVector<Obj> v(3);
+        Obj bad;
+        bad.throw_on_copy = true;
+        const size_t capacity = v.Capacity();
+        try {
+            v.PushBack(bad);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 3 && v.Capacity() == capacity);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    // Элементы с увеличенным выравниванием
+    {
+        struct alignas(64) Wide {
+            int value = 0;
+        };
+        ThinVector<Wide> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(Wide{i});
+        }
+        for (const Wide& wide : v) {
+            assert(reinterpret_cast<uintptr_t>(&wide) % 64 == 0);
+        }
+        assert(v[4].value == 4);
+    }
+}
+
+void Test27() {
+#if !defined(VECTOR_ENABLE_STATS) && !defined(VECTOR_ENABLE_RECORDING)
+    static_assert(sizeof(Vector<int, uint32_t>) == 16);
+    static_assert(sizeof(Vector<Vector<int, uint32_t>, uint32_t>) == 16);
+#endif
+    // Тот же интерфейс, что и с size_t
+    {
+        Obj::ResetCounters();
+        Vector<Obj, uint32_t> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Insert(v.cbegin() + 1, Obj(10));
+        v.Erase(v.cbegin());
+        Vector<Obj, uint32_t> copy(v);
+        v = std::move(copy);
+        v.Resize(7);
+        assert(v.Size() == 7 && v.Capacity() == 7);
+        assert(v[0].id == 10 && v[1].id == 1 && v[4].id == 4 && v[6].id == 0);
+        assert(Obj::GetAliveObjectCount() == 7);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    // Рост упирается в предел SizeType: вместимость обрезается до него, дальше — std::length_error
+    {
+        Vector<char, uint8_t> v;
+        for (int i = 0; i < 255; ++i) {
+            v.PushBack(static_cast<char>(i));
+        }
+        assert(v.Size() == 255 && v.Capacity() == 255);
+        const auto expect_length_error = [](auto&& fn) {
+            try {
+                fn();
+                assert(false && "Exception is expected");
+            } catch (const std::length_error&) {
+            }
+        };
+        expect_length_error([&] { v.PushBack('x'); });
+        expect_length_error([&] { v.EmplaceBack('x'); });
+        expect_length_error([&] { v.Emplace(v.cbegin(), 'x'); });
+        expect_length_error([&] { v.Reserve(256); });
+        expect_length_error([&] { v.Resize(300); });
+        expect_length_error([] { Vector<char, uint8_t> big(256); });
+        assert(v.Size() == 255 && v.Capacity() == 255 && v[254] == static_cast<char>(254));
+
+        Vector<uint16_t, uint16_t> w(40000);
+        expect_length_error([&] { w.Resize(70000); });
+        w.PushBack(1);
+        assert(w.Size() == 40001 && w.Capacity() == 65535);
+    }
+    // Выражения vector_expr.h работают и с 32-битными векторами
+    {
+        Vector<double, uint32_t> a(3);
+        a[0] = 1;
+        a[1] = 2;
+        a[2] = 3;
+        Vector<double, uint32_t> b = a * 2.0 + a;
+        assert(b.Size() == 3 && b[0] == 3 && b[2] == 9);
+    }
+    // Векторные ядра и сериализация принимают любой размерный тип
+    {
+        Vector<int32_t, uint32_t> v(100);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            v[i] = static_cast<int32_t>(i % 10);
+        }
+        assert(Find(v, 7) == v.begin() + 7 && Count(v, 3) == 10 && Sum(v) == 450);
+        assert(EraseValue(v, 0) == 10 && v.Size() == 90);
+
+        BufferWriter writer;
+        Serialize(v, writer);
+        const auto view = VectorView<int32_t>::Load(writer.Data(), writer.Size());
+        assert(std::equal(view.begin(), view.end(), v.begin(), v.end()));
+    }
+}
+
+void Test28() {
+#if !defined(VECTOR_ENABLE_STATS) && !defined(VECTOR_ENABLE_RECORDING)
+    // Пустой HeapAllocator не занимает места, указатель на арену — 8 байт
+    static_assert(sizeof(Vector<int>) == 24);
+    static_assert(sizeof(ArenaVector<int>) == 32);
+    static_assert(sizeof(ArenaVector<int, uint32_t>) == 24);
+#endif
+    // Строки берут память из арены, переданной при создании
+    {
+        Obj::ResetCounters();
+        VectorArena arena(1024);
+        {
+            Vector<ArenaVector<Obj>> rows;
+            for (int i = 0; i < 20; ++i) {
+                ArenaVector<Obj>& row = rows.EmplaceBack(arena);
+                for (int j = 0; j < i; ++j) {
+                    row.EmplaceBack(i * 100 + j);
+                }
+            }
+            for (size_t i = 0; i < rows.Size(); ++i) {
+                assert(rows[i].GetAllocator().Arena() == &arena);
+                assert(rows[i].Size() == i);
+                for (size_t j = 0; j < i; ++j) {
+                    assert(rows[i][j].id == static_cast<int>(i * 100 + j));
+                }
+            }
+            assert(arena.BytesUsed() > 0 && arena.BytesUsed() <= arena.BytesReserved());
+            assert(Obj::GetAliveObjectCount() == 190);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        arena.Reset();
+        assert(arena.BytesUsed() == 0 && arena.BytesReserved() == 0);
+    }
+    // Место последнего выданного буфера возвращается арене, остальные остаются до Reset
+    {
+        VectorArena arena;
+        ArenaVector<int> v(arena);
+        v.Reserve(4);
+        assert(arena.BytesUsed() == 4 * sizeof(int));
+        v.Reserve(8);
+        assert(arena.BytesUsed() == 12 * sizeof(int));
+        {
+            ArenaVector<int> tmp(arena);
+            tmp.Reserve(16);
+            assert(arena.BytesUsed() == 28 * sizeof(int));
+        }
+        assert(arena.BytesUsed() == 12 * sizeof(int));
+        v.PushBack(1);
+        v = ArenaVector<int>(arena);
+        assert(arena.BytesUsed() == 4 * sizeof(int));
+    }
+    // Крупный буфер получает собственный блок, выравнивание элементов соблюдается
+    {
+        struct alignas(64) Wide {
+            int value = 0;
+        };
+        VectorArena arena(1024);
+        ArenaVector<char> small(arena);
+        small.PushBack('x');
+        ArenaVector<Wide> wide(arena);
+        for (int i = 0; i < 5; ++i) {
+            wide.PushBack(Wide{i});
+        }
+        for (const Wide& w : wide) {
+            assert(reinterpret_cast<uintptr_t>(&w) % 64 == 0);
+        }
+        ArenaVector<int> big(arena);
+        big.Reserve(1000);
+        assert(arena.BytesReserved() >= 1000 * sizeof(int) + 1024);
+        big.Resize(1000);
+        small.PushBack('y');
+        assert(small[0] == 'x' && small[1] == 'y' && wide[4].value == 4 && big[999] == 0);
+    }
+    // Внутри VectorArenaScope арену получают векторы, созданные без аргументов
+    {
+        VectorArena arena;
+        Vector<ArenaVector<int>> rows;
+        {
+            VectorArenaScope scope(arena);
+            rows.Resize(3);
+            VectorArena nested_arena;
+            {
+                VectorArenaScope nested(nested_arena);
+                assert(VectorArena::Current() == &nested_arena);
+            }
+            assert(VectorArena::Current() == &arena);
+        }
+        assert(VectorArena::Current() == nullptr);
+        rows[2].PushBack(5);
+        assert(rows[2].GetAllocator().Arena() == &arena && arena.BytesUsed() == sizeof(int));
+
+        // Без арены и без области выделение бросает исключение
+        ArenaVector<int> orphan;
+        try {
+            orphan.PushBack(1);
+            assert(false && "Exception is expected");
+        } catch (const std::logic_error&) {
+        }
+        assert(orphan.Size() == 0);
+    }
+    // Копия берёт арену оригинала, присваивание сохраняет свою, перемещение переносит арену с данными
+    {
+        VectorArena first;
+        VectorArena second;
+        ArenaVector<int> a(first);
+        for (int i = 0; i < 10; ++i) {
+            a.PushBack(i);
+        }
+        ArenaVector<int> copy(a);
+        assert(copy.GetAllocator().Arena() == &first);
+        ArenaVector<int> b(second);
+        b = a;
+        assert(b.GetAllocator().Arena() == &second && second.BytesUsed() == 10 * sizeof(int));
+        assert(b.Size() == 10 && b[9] == 9);
+        ArenaVector<int> moved(std::move(b));
+        assert(moved.GetAllocator().Arena() == &second && moved[9] == 9);
+        moved.Swap(a);
+        assert(moved.GetAllocator().Arena() == &first && a.GetAllocator().Arena() == &second);
+    }
+}
+
+void Test29() {
+    // Копирующий Freeze: строки остаются на месте
+    {
+        Vector<Vector<int>> rows;
+        for (int i = 0; i < 5; ++i) {
+            Vector<int>& row = rows.EmplaceBack();
+            for (int j = 0; j < i; ++j) {
+                row.PushBack(i * 10 + j);
+            }
+        }
+        rows.EmplaceBack();
+        JaggedVector<int> jagged = Freeze(rows);
+        assert(rows.Size() == 6 && rows[4].Size() == 4);
+        assert(jagged.Size() == 6 && jagged.TotalSize() == 10);
+        assert(jagged.Offsets().Size() == 7 && jagged.Offsets()[3] == 3 && jagged.Offsets()[6] == 10);
+        for (size_t i = 0; i < rows.Size(); ++i) {
+            assert(jagged[i].Size() == rows[i].Size());
+            assert(std::equal(jagged[i].begin(), jagged[i].end(), rows[i].begin(), rows[i].end()));
+        }
+        jagged[3][1] = 100;
+        const JaggedVector<int>& view = jagged;
+        assert(view[3][1] == 100 && rows[3][1] == 31);
+
+        size_t row_count = 0;
+        int sum = 0;
+        for (auto row : view) {
+            ++row_count;
+            for (int value : row) {
+                sum += value;
+            }
+        }
+        assert(row_count == 6 && sum == 10 + 20 + 21 + 30 + 100 + 32 + 40 + 41 + 42 + 43);
+
+        JaggedVector<int> empty = Freeze(Vector<Vector<int>>());
+        assert(empty.Size() == 0 && empty.TotalSize() == 0 && empty.begin() == empty.end());
+        JaggedVector<int> default_constructed;
+        assert(default_constructed.Size() == 0);
+        empty.Swap(jagged);
+        assert(empty.Size() == 6 && jagged.Size() == 0);
+    }
+    // Перемещающий Freeze забирает элементы из строк в арене, после чего арену можно сбросить
+    {
+        Obj::ResetCounters();
+        VectorArena arena;
+        Vector<ArenaVector<Obj>> rows;
+        for (int i = 0; i < 8; ++i) {
+            ArenaVector<Obj>& row = rows.EmplaceBack(arena);
+            for (int j = 0; j < i % 3; ++j) {
+                row.EmplaceBack(i * 10 + j);
+            }
+        }
+        const int copied_before = Obj::num_copied;
+        JaggedVector<Obj> jagged = Freeze(std::move(rows));
+        assert(rows.Size() == 0 && rows.Capacity() == 0);
+        assert(Obj::num_copied == copied_before);
+        arena.Reset();
+        assert(jagged.Size() == 8 && jagged.TotalSize() == 7);
+        assert(Obj::GetAliveObjectCount() == 7);
+        assert(jagged[0].Size() == 0 && jagged[2].Size() == 2 && jagged[2][1].id == 21 && jagged[7][0].id == 70);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
 int main() {
     try {
         Test1();
@@ -647,8 +2653,32 @@ int main() {
         Test4();
         Test5();
         Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
         Benchmark();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,336 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Вектор, элементы которого хранятся в отображённом в память файле.
+// Файл состоит из заголовка (размер, размер элемента) и массива элементов,
+// поэтому повторное открытие не требует десериализации: элементы доступны сразу
+// после mmap, а страницы подгружаются с диска по мере обращения.
+// Рост — через ftruncate и mremap, сброс на диск — Flush().
+template <typename T>
+class MappedVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "MappedVector stores raw bytes of T in a file");
+
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t size;
+    };
+
+    static constexpr uint64_t kMagic = 0x31564d4150504d56; // "VMPPAMV1"
+    static constexpr uint32_t kVersion = 1;
+    // Элементы начинаются с границы кэш-линии
+    static constexpr size_t kHeaderSize = 64;
+    static_assert(sizeof(Header) <= kHeaderSize && alignof(T) <= kHeaderSize);
+
+public:
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    MappedVector() = default;
+
+    // Открывает существующий файл или создаёт новый пустой
+    explicit MappedVector(const std::string &path)
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            ThrowSystemError("open");
+        }
+
+        try
+        {
+            struct stat st;
+            if (::fstat(fd_, &st) != 0)
+            {
+                ThrowSystemError("fstat");
+            }
+
+            if (st.st_size == 0)
+            {
+                Truncate(kHeaderSize);
+                Map(kHeaderSize);
+                *GetHeader() = Header{kMagic, kVersion, static_cast<uint32_t>(sizeof(T)), 0};
+                return;
+            }
+
+            if (static_cast<size_t>(st.st_size) < kHeaderSize)
+            {
+                throw std::runtime_error("MappedVector: file is too small: " + path);
+            }
+            Map(static_cast<size_t>(st.st_size));
+            const Header &header = *GetHeader();
+            if (header.magic != kMagic || header.version != kVersion)
+            {
+                throw std::runtime_error("MappedVector: not a vector file: " + path);
+            }
+            if (header.element_size != sizeof(T))
+            {
+                throw std::runtime_error("MappedVector: element size mismatch: " + path);
+            }
+            if (header.size > Capacity())
+            {
+                throw std::runtime_error("MappedVector: file is truncated: " + path);
+            }
+        }
+        catch (...)
+        {
+            Close();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector &) = delete;
+    MappedVector &operator=(const MappedVector &) = delete;
+
+    MappedVector(MappedVector &&other) noexcept
+        : fd_{std::exchange(other.fd_, -1)},
+          map_{std::exchange(other.map_, nullptr)},
+          mapped_bytes_{std::exchange(other.mapped_bytes_, 0)}
+    {
+    }
+
+    MappedVector &operator=(MappedVector &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Close();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~MappedVector()
+    {
+        Close();
+    }
+
+    bool IsOpen() const noexcept
+    {
+        return map_ != nullptr;
+    }
+
+    iterator begin() noexcept
+    {
+        return Data();
+    }
+    iterator end() noexcept
+    {
+        return Data() + Size();
+    }
+    const_iterator begin() const noexcept
+    {
+        return Data();
+    }
+    const_iterator end() const noexcept
+    {
+        return Data() + Size();
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return IsOpen() ? static_cast<size_t>(GetHeader()->size) : 0;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return IsOpen() ? (mapped_bytes_ - kHeaderSize) / sizeof(T) : 0;
+    }
+
+    const T &operator[](size_t index) const noexcept
+    {
+        return const_cast<MappedVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return Data()[index];
+    }
+
+    // Увеличивает файл и отображение до new_capacity элементов
+    void Reserve(size_t new_capacity)
+    {
+        assert(IsOpen());
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+
+        // Размер файла ограничен и size_t, и off_t; без проверки произведение переполнится,
+        // и файл урежется вместо роста
+        constexpr uint64_t max_bytes =
+            std::min<uint64_t>(std::numeric_limits<size_t>::max(), std::numeric_limits<off_t>::max());
+        if (new_capacity > (max_bytes - kHeaderSize) / sizeof(T))
+        {
+            throw std::length_error("MappedVector: capacity is too large");
+        }
+        const size_t new_bytes = kHeaderSize + new_capacity * sizeof(T);
+        Truncate(new_bytes);
+        Remap(new_bytes);
+    }
+
+    void Resize(size_t new_size)
+    {
+        const size_t size = Size();
+        if (new_size > size)
+        {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(Data() + size, new_size - size);
+        }
+        GetHeader()->size = new_size;
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args)
+    {
+        const size_t size = Size();
+        if (size == Capacity())
+        {
+            // Значение создаётся до роста: аргументы могут ссылаться на элементы вектора
+            T value(std::forward<Args>(args)...);
+            Reserve(size == 0 ? 1 : 2 * size);
+            new (Data() + size) T(std::move(value));
+        }
+        else
+        {
+            new (Data() + size) T(std::forward<Args>(args)...);
+        }
+        GetHeader()->size = size + 1;
+        return Data()[size];
+    }
+
+    void PushBack(const T &value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept
+    {
+        assert(Size() != 0);
+        --GetHeader()->size;
+    }
+
+    // Синхронно записывает изменённые страницы на диск
+    void Flush()
+    {
+        assert(IsOpen());
+        if (::msync(map_, mapped_bytes_, MS_SYNC) != 0)
+        {
+            ThrowSystemError("msync");
+        }
+    }
+
+    void Swap(MappedVector &other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(map_, other.map_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+    }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const char *what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    Header *GetHeader() noexcept
+    {
+        return reinterpret_cast<Header *>(map_);
+    }
+
+    const Header *GetHeader() const noexcept
+    {
+        return reinterpret_cast<const Header *>(map_);
+    }
+
+    T *Data() noexcept
+    {
+        return IsOpen() ? reinterpret_cast<T *>(static_cast<char *>(map_) + kHeaderSize) : nullptr;
+    }
+
+    const T *Data() const noexcept
+    {
+        return const_cast<MappedVector &>(*this).Data();
+    }
+
+    void Truncate(size_t bytes)
+    {
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0)
+        {
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    void Map(size_t bytes)
+    {
+        void *map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED)
+        {
+            ThrowSystemError("mmap");
+        }
+        map_ = map;
+        mapped_bytes_ = bytes;
+    }
+
+    void Remap(size_t bytes)
+    {
+#ifdef __linux__
+        void *map = ::mremap(map_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (map == MAP_FAILED)
+        {
+            ThrowSystemError("mremap");
+        }
+        map_ = map;
+        mapped_bytes_ = bytes;
+#else
+        void *old_map = map_;
+        const size_t old_bytes = mapped_bytes_;
+        Map(bytes);
+        ::munmap(old_map, old_bytes);
+#endif
+    }
+
+    void Close() noexcept
+    {
+        if (map_ != nullptr)
+        {
+            ::munmap(map_, mapped_bytes_);
+            map_ = nullptr;
+            mapped_bytes_ = 0;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    void *map_ = nullptr;
+    size_t mapped_bytes_ = 0;
+};
@@ -0,0 +1,374 @@
+#pragma once
+#include "vector.h"
+#include "vector_simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+// Сжатый вектор беззнаковых целых: значения разбиты на блоки по 128 штук,
+// каждый блок упакован по битам с собственной шириной.
+//
+// FrameOfReference — в блоке хранятся разности со своим минимумом, подходит для
+// значений из узкого диапазона. Delta — хранятся разности соседних значений одной дорожки,
+// подходит для неубывающих последовательностей (списки документов, отметки времени);
+// на произвольных данных результат верен, но сжатие плохое.
+//
+// Блок хранится «вертикально»: значение j попадает в дорожку j % kLanes, где kLanes
+// значений помещаются в 128-битный регистр. Все дорожки упаковываются одинаково,
+// поэтому распаковка блока — цикл по дорожкам, который компилятор векторизует.
+// Для каждого блока хранятся смещение в упакованных словах, база и ширина,
+// так что доступ по индексу распаковывает одно значение (Delta — одну дорожку).
+// Новые значения копятся в несжатом хвосте и упаковываются по заполнении блока.
+enum class PackedEncoding
+{
+    FrameOfReference,
+    Delta,
+};
+
+namespace packed_int
+{
+    inline constexpr size_t kBlockSize = 128;
+
+    template <typename T>
+    inline constexpr size_t kLanes = 16 / sizeof(T);
+
+    // Бит в слове, и это же число значений в одной дорожке блока
+    template <typename T>
+    inline constexpr unsigned kBits = 8 * sizeof(T);
+
+    template <typename T>
+    unsigned BitWidth(T x) noexcept
+    {
+        unsigned width = 0;
+        for (; x != 0; x >>= 1)
+        {
+            ++width;
+        }
+        return width;
+    }
+
+    template <typename T>
+    constexpr T WidthMask(unsigned width) noexcept
+    {
+        return width == kBits<T> ? ~T{} : static_cast<T>((T{1} << width) - 1);
+    }
+
+    // Упаковывает kBlockSize значений шириной width в kLanes * width слов
+    template <typename T>
+    VECTOR_SIMD_CLONES void PackBlock(const T *__restrict values, unsigned width, T *__restrict out) noexcept
+    {
+        constexpr size_t kL = kLanes<T>;
+        constexpr unsigned kW = kBits<T>;
+        if (width == 0)
+        {
+            return;
+        }
+        T acc[kL] = {};
+        unsigned shift = 0;
+        for (size_t i = 0; i < kW; ++i)
+        {
+            const T *row = values + i * kL;
+            for (size_t lane = 0; lane < kL; ++lane)
+            {
+                acc[lane] |= static_cast<T>(row[lane] << shift);
+            }
+            shift += width;
+            if (shift >= kW)
+            {
+                shift -= kW;
+                for (size_t lane = 0; lane < kL; ++lane)
+                {
+                    out[lane] = acc[lane];
+                    // Старшие биты значения, не поместившиеся в записанное слово
+                    acc[lane] = shift == 0 ? T{} : static_cast<T>(row[lane] >> (width - shift));
+                }
+                out += kL;
+            }
+        }
+    }
+
+    // Распаковывает блок в out. FrameOfReference: out = base + значение;
+    // Delta: out — накопленная по дорожке сумма, начиная с base
+    template <typename T, PackedEncoding Encoding>
+    VECTOR_SIMD_CLONES void UnpackBlock(const T *__restrict words, unsigned width, T base, T *__restrict out) noexcept
+    {
+        constexpr size_t kL = kLanes<T>;
+        constexpr unsigned kW = kBits<T>;
+        if (width == 0)
+        {
+            std::fill_n(out, kBlockSize, base);
+            return;
+        }
+        const T mask = WidthMask<T>(width);
+        T acc[kL];
+        for (size_t lane = 0; lane < kL; ++lane)
+        {
+            acc[lane] = base;
+        }
+        unsigned shift = 0;
+        for (size_t i = 0; i < kW; ++i)
+        {
+            T *row = out + i * kL;
+            if (shift + width > kW)
+            {
+                // Значение разрезано между двумя словами дорожки
+                for (size_t lane = 0; lane < kL; ++lane)
+                {
+                    const T x = static_cast<T>((words[lane] >> shift) | (words[kL + lane] << (kW - shift))) & mask;
+                    if constexpr (Encoding == PackedEncoding::Delta)
+                    {
+                        row[lane] = acc[lane] += x;
+                    }
+                    else
+                    {
+                        row[lane] = base + x;
+                    }
+                }
+            }
+            else
+            {
+                for (size_t lane = 0; lane < kL; ++lane)
+                {
+                    const T x = static_cast<T>(words[lane] >> shift) & mask;
+                    if constexpr (Encoding == PackedEncoding::Delta)
+                    {
+                        row[lane] = acc[lane] += x;
+                    }
+                    else
+                    {
+                        row[lane] = base + x;
+                    }
+                }
+            }
+            shift += width;
+            if (shift >= kW)
+            {
+                shift -= kW;
+                words += kL;
+            }
+        }
+    }
+
+    // Значение с номером pos в дорожке lane упакованного блока
+    template <typename T>
+    T ExtractValue(const T *words, unsigned width, size_t lane, size_t pos) noexcept
+    {
+        constexpr size_t kL = kLanes<T>;
+        constexpr unsigned kW = kBits<T>;
+        if (width == 0)
+        {
+            return T{};
+        }
+        const size_t bit = pos * width;
+        const T *word = words + (bit / kW) * kL + lane;
+        const unsigned shift = static_cast<unsigned>(bit % kW);
+        T x = static_cast<T>(word[0] >> shift);
+        if (shift + width > kW)
+        {
+            x |= static_cast<T>(word[kL] << (kW - shift));
+        }
+        return x & WidthMask<T>(width);
+    }
+
+} // namespace packed_int
+
+template <typename T, PackedEncoding Encoding = PackedEncoding::FrameOfReference>
+class PackedIntVector
+{
+    static_assert(std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>,
+                  "PackedIntVector stores unsigned integers");
+
+    static constexpr size_t kL = packed_int::kLanes<T>;
+
+    // Указатель пропуска: где начинается блок и как его распаковать
+    struct BlockInfo
+    {
+        size_t offset;
+        T base;
+        uint8_t width;
+    };
+
+public:
+    static constexpr size_t kBlockSize = packed_int::kBlockSize;
+
+    PackedIntVector() = default;
+
+    explicit PackedIntVector(const Vector<T> &values)
+    {
+        Append(values.begin(), values.Size());
+    }
+
+    size_t Size() const noexcept
+    {
+        return blocks_.Size() * kBlockSize + tail_.Size();
+    }
+
+    // Число блоков, включая неполный хвост
+    size_t BlockCount() const noexcept
+    {
+        return blocks_.Size() + (tail_.Size() != 0);
+    }
+
+    // Байт занято под данные (без учёта запаса ёмкости)
+    size_t MemoryUsage() const noexcept
+    {
+        return words_.Size() * sizeof(T) + blocks_.Size() * sizeof(BlockInfo) + tail_.Size() * sizeof(T);
+    }
+
+    T operator[](size_t index) const noexcept
+    {
+        assert(index < Size());
+        const size_t block = index / kBlockSize;
+        if (block == blocks_.Size())
+        {
+            return tail_[index % kBlockSize];
+        }
+
+        const BlockInfo &info = blocks_[block];
+        const T *words = words_.begin() + info.offset;
+        const size_t lane = index % kL;
+        const size_t pos = (index % kBlockSize) / kL;
+        if constexpr (Encoding == PackedEncoding::Delta)
+        {
+            T value = info.base;
+            for (size_t p = 0; p <= pos; ++p)
+            {
+                value += packed_int::ExtractValue(words, info.width, lane, p);
+            }
+            return value;
+        }
+        else
+        {
+            return info.base + packed_int::ExtractValue(words, info.width, lane, pos);
+        }
+    }
+
+    void PushBack(T value)
+    {
+        if (tail_.Capacity() == 0)
+        {
+            tail_.Reserve(kBlockSize);
+        }
+        tail_.PushBack(value);
+        if (tail_.Size() == kBlockSize)
+        {
+            EncodeBlock(tail_.begin());
+            tail_.Resize(0);
+        }
+    }
+
+    void Append(const T *values, size_t count)
+    {
+        // Целые блоки упаковываются прямо из источника, минуя хвост
+        while (count != 0 && tail_.Size() != 0)
+        {
+            PushBack(*values++);
+            --count;
+        }
+        for (; count >= kBlockSize; count -= kBlockSize, values += kBlockSize)
+        {
+            EncodeBlock(values);
+        }
+        for (; count != 0; --count)
+        {
+            PushBack(*values++);
+        }
+    }
+
+    void Append(const Vector<T> &values)
+    {
+        Append(values.begin(), values.Size());
+    }
+
+    // Распаковывает блок с номером block в out (не меньше kBlockSize элементов).
+    // Возвращает число значений в блоке: kBlockSize, меньше — только у хвоста
+    size_t DecodeBlock(size_t block, T *out) const noexcept
+    {
+        assert(block < BlockCount());
+        if (block == blocks_.Size())
+        {
+            std::copy(tail_.begin(), tail_.end(), out);
+            return tail_.Size();
+        }
+        const BlockInfo &info = blocks_[block];
+        packed_int::UnpackBlock<T, Encoding>(words_.begin() + info.offset, info.width, info.base, out);
+        return kBlockSize;
+    }
+
+    // Распаковывает все значения в out, заменяя его содержимое
+    void DecodeTo(Vector<T> &out) const
+    {
+        out.Resize(Size());
+        T *dest = out.begin();
+        for (size_t block = 0; block < blocks_.Size(); ++block, dest += kBlockSize)
+        {
+            DecodeBlock(block, dest);
+        }
+        std::copy(tail_.begin(), tail_.end(), dest);
+    }
+
+    void Clear() noexcept
+    {
+        words_.Resize(0);
+        blocks_.Resize(0);
+        tail_.Resize(0);
+    }
+
+    void Swap(PackedIntVector &other) noexcept
+    {
+        words_.Swap(other.words_);
+        blocks_.Swap(other.blocks_);
+        tail_.Swap(other.tail_);
+    }
+
+private:
+    void EncodeBlock(const T *values)
+    {
+        T buffer[kBlockSize];
+        T base;
+        if constexpr (Encoding == PackedEncoding::Delta)
+        {
+            // База — минимум первой строки, дальше разности с предыдущим значением дорожки
+            base = *std::min_element(values, values + kL);
+            for (size_t i = 0; i < kL; ++i)
+            {
+                buffer[i] = values[i] - base;
+            }
+            for (size_t i = kL; i < kBlockSize; ++i)
+            {
+                buffer[i] = values[i] - values[i - kL];
+            }
+        }
+        else
+        {
+            base = *std::min_element(values, values + kBlockSize);
+            for (size_t i = 0; i < kBlockSize; ++i)
+            {
+                buffer[i] = values[i] - base;
+            }
+        }
+
+        T all_bits = 0;
+        for (size_t i = 0; i < kBlockSize; ++i)
+        {
+            all_bits |= buffer[i];
+        }
+        const unsigned width = packed_int::BitWidth(all_bits);
+
+        const size_t offset = words_.Size();
+        const size_t new_size = offset + kL * width;
+        // Resize резервирует ровно столько, сколько просят, поэтому рост задаётся здесь
+        if (new_size > words_.Capacity())
+        {
+            words_.Reserve(std::max(new_size, 2 * words_.Capacity()));
+        }
+        words_.Resize(new_size);
+        packed_int::PackBlock(buffer, width, words_.begin() + offset);
+        blocks_.PushBack(BlockInfo{offset, base, static_cast<uint8_t>(width)});
+    }
+
+    Vector<T> words_;
+    Vector<BlockInfo> blocks_;
+    Vector<T> tail_;
+};
@@ -0,0 +1,460 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Вектор в сегменте разделяемой памяти POSIX (shm_open или memfd_create).
+// Один процесс-писатель изменяет вектор, любое число процессов-читателей видят его без копирования.
+//
+// Сегмент начинается с управляющего блока, элементы лежат по смещению data_offset от начала
+// сегмента, поэтому каждый процесс может отобразить его по любому адресу. Согласованность
+// обеспечивает seqlock: писатель делает счётчик поколений нечётным на время изменения,
+// читатель повторяет чтение, если счётчик изменился или был нечётным.
+// При росте писатель увеличивает сегмент, а читатели переотображают его, заметив новую вместимость.
+//
+// Один объект SharedVector не предназначен для одновременного использования из нескольких потоков.
+template <typename T>
+class SharedVector
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SharedVector stores raw bytes of T in shared memory");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "Process-shared atomics must be lock-free");
+
+    struct Control
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t data_offset;
+        std::atomic<uint64_t> sequence;
+        std::atomic<uint64_t> size;
+        std::atomic<uint64_t> capacity;
+    };
+
+    static constexpr uint64_t kMagic = 0x3144524148534356; // "VCSHARD1"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kDataOffset = 64;
+    static_assert(sizeof(Control) <= kDataOffset && alignof(T) <= kDataOffset);
+
+public:
+    SharedVector() = default;
+
+    // Создаёт именованный сегмент для писателя. Сегмент с таким именем не должен существовать
+    static SharedVector Create(const std::string &name, size_t capacity = 0)
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0)
+        {
+            ThrowSystemError("shm_open");
+        }
+        try
+        {
+            return Initialize(fd, capacity);
+        }
+        catch (...)
+        {
+            // Сегмент создан этим вызовом, и без удаления имя осталось бы занятым
+            Unlink(name);
+            throw;
+        }
+    }
+
+#ifdef __linux__
+    // Создаёт безымянный сегмент для писателя; читателям передаётся Fd() (например, через fork)
+    static SharedVector CreateAnonymous(size_t capacity = 0)
+    {
+        const int fd = ::memfd_create("SharedVector", MFD_CLOEXEC);
+        if (fd < 0)
+        {
+            ThrowSystemError("memfd_create");
+        }
+        return Initialize(fd, capacity);
+    }
+#endif
+
+    // Открывает именованный сегмент для чтения
+    static SharedVector Open(const std::string &name)
+    {
+        const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+        {
+            ThrowSystemError("shm_open");
+        }
+        return Attach(fd);
+    }
+
+    // Открывает для чтения сегмент по дескриптору. Дескриптор дублируется
+    static SharedVector OpenFd(int fd)
+    {
+        const int dup_fd = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (dup_fd < 0)
+        {
+            ThrowSystemError("fcntl");
+        }
+        return Attach(dup_fd);
+    }
+
+    static void Unlink(const std::string &name) noexcept
+    {
+        ::shm_unlink(name.c_str());
+    }
+
+    SharedVector(const SharedVector &) = delete;
+    SharedVector &operator=(const SharedVector &) = delete;
+
+    SharedVector(SharedVector &&other) noexcept
+        : fd_{std::exchange(other.fd_, -1)},
+          map_{std::exchange(other.map_, nullptr)},
+          mapped_bytes_{std::exchange(other.mapped_bytes_, 0)},
+          writable_{std::exchange(other.writable_, false)}
+    {
+    }
+
+    SharedVector &operator=(SharedVector &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Close();
+            Swap(rhs);
+        }
+        return *this;
+    }
+
+    ~SharedVector()
+    {
+        Close();
+    }
+
+    int Fd() const noexcept
+    {
+        return fd_;
+    }
+
+    bool IsWriter() const noexcept
+    {
+        return writable_;
+    }
+
+    // Номер поколения: растёт на единицу с каждым завершённым изменением
+    uint64_t Generation() const noexcept
+    {
+        return GetControl().sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    // Вызывает fn(const T *data, size_t size) на согласованном состоянии вектора и возвращает
+    // его результат. fn может быть вызвана несколько раз и видеть несогласованные данные
+    // в попытках, которые будут отброшены, поэтому она не должна иметь побочных эффектов
+    // и обязана быть устойчивой к любым значениям элементов
+    template <typename F>
+    auto Read(F &&fn) const
+    {
+        while (true)
+        {
+            // Переотображение может сдвинуть сегмент, поэтому адрес берётся заново на каждой попытке
+            const Control &control = GetControl();
+            const uint64_t begin = control.sequence.load(std::memory_order_acquire);
+            if (begin % 2 != 0)
+            {
+                continue;
+            }
+
+            const size_t capacity = control.capacity.load(std::memory_order_relaxed);
+            if (capacity > MappedCapacity())
+            {
+                Remap(BytesFor(capacity));
+                continue;
+            }
+            const size_t size = std::min<size_t>(control.size.load(std::memory_order_relaxed), capacity);
+            auto result = fn(static_cast<const T *>(Data()), size);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (control.sequence.load(std::memory_order_relaxed) == begin)
+            {
+                return result;
+            }
+        }
+    }
+
+    // Согласованная копия содержимого
+    Vector<T> Snapshot() const
+    {
+        Vector<T> copy;
+        Read([&copy](const T *data, size_t size) {
+            copy.Resize(size);
+            std::copy_n(data, size, copy.begin());
+            return 0;
+        });
+        return copy;
+    }
+
+    // Размер и вместимость читаются без синхронизации с данными
+    size_t Size() const noexcept
+    {
+        return GetControl().size.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return GetControl().capacity.load(std::memory_order_acquire);
+    }
+
+    // Операции писателя
+
+    void Reserve(size_t new_capacity)
+    {
+        assert(writable_);
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        const size_t bytes = BytesFor(new_capacity);
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0)
+        {
+            ThrowSystemError("ftruncate");
+        }
+        Remap(bytes);
+        // Данные не перемещаются: сегмент только удлиняется, читатели переотобразят его сами
+        GetControl().capacity.store(new_capacity, std::memory_order_release);
+    }
+
+    void PushBack(const T &value)
+    {
+        assert(writable_);
+        const size_t size = Size();
+        if (size == Capacity())
+        {
+            const T copy = value;
+            Reserve(size == 0 ? 1 : 2 * size);
+            Write([&] {
+                Data()[size] = copy;
+                GetControl().size.store(size + 1, std::memory_order_relaxed);
+            });
+            return;
+        }
+        Write([&] {
+            Data()[size] = value;
+            GetControl().size.store(size + 1, std::memory_order_relaxed);
+        });
+    }
+
+    void PopBack()
+    {
+        assert(writable_ && Size() != 0);
+        Write([&] {
+            GetControl().size.fetch_sub(1, std::memory_order_relaxed);
+        });
+    }
+
+    void Set(size_t index, const T &value)
+    {
+        assert(writable_ && index < Size());
+        Write([&] {
+            Data()[index] = value;
+        });
+    }
+
+    void Resize(size_t new_size)
+    {
+        assert(writable_);
+        Reserve(new_size);
+        Write([&] {
+            const size_t size = Size();
+            if (new_size > size)
+            {
+                std::uninitialized_value_construct_n(Data() + size, new_size - size);
+            }
+            GetControl().size.store(new_size, std::memory_order_relaxed);
+        });
+    }
+
+    // Заменяет всё содержимое одним изменением: читатели увидят либо старые данные, либо новые
+    void Assign(const T *data, size_t size)
+    {
+        assert(writable_);
+        Reserve(size);
+        Write([&] {
+            std::copy_n(data, size, Data());
+            GetControl().size.store(size, std::memory_order_relaxed);
+        });
+    }
+
+    // Произвольное изменение под seqlock: fn(T *data, size_t size) меняет элементы на месте
+    template <typename F>
+    void Update(F &&fn)
+    {
+        assert(writable_);
+        Write([&] {
+            fn(Data(), Size());
+        });
+    }
+
+    void Swap(SharedVector &other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(map_, other.map_);
+        std::swap(mapped_bytes_, other.mapped_bytes_);
+        std::swap(writable_, other.writable_);
+    }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const char *what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static size_t BytesFor(size_t capacity) noexcept
+    {
+        return kDataOffset + capacity * sizeof(T);
+    }
+
+    static SharedVector Initialize(int fd, size_t capacity)
+    {
+        SharedVector v;
+        v.fd_ = fd;
+        v.writable_ = true;
+        const size_t bytes = BytesFor(capacity);
+        if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        {
+            ThrowSystemError("ftruncate");
+        }
+        v.Map(bytes);
+
+        Control &control = v.GetControl();
+        control.magic = kMagic;
+        control.version = kVersion;
+        control.element_size = sizeof(T);
+        control.data_offset = kDataOffset;
+        control.size.store(0, std::memory_order_relaxed);
+        control.capacity.store(capacity, std::memory_order_relaxed);
+        control.sequence.store(0, std::memory_order_release);
+        return v;
+    }
+
+    static SharedVector Attach(int fd)
+    {
+        SharedVector v;
+        v.fd_ = fd;
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ThrowSystemError("fstat");
+        }
+        if (static_cast<size_t>(st.st_size) < kDataOffset)
+        {
+            throw std::runtime_error("SharedVector: segment is too small");
+        }
+        v.Map(static_cast<size_t>(st.st_size));
+
+        const Control &control = v.GetControl();
+        if (control.magic != kMagic || control.version != kVersion || control.data_offset != kDataOffset)
+        {
+            throw std::runtime_error("SharedVector: not a vector segment");
+        }
+        if (control.element_size != sizeof(T))
+        {
+            throw std::runtime_error("SharedVector: element size mismatch");
+        }
+        return v;
+    }
+
+    template <typename F>
+    void Write(F &&fn)
+    {
+        Control &control = GetControl();
+        const uint64_t sequence = control.sequence.load(std::memory_order_relaxed);
+        control.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        fn();
+        control.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    Control &GetControl() noexcept
+    {
+        return *reinterpret_cast<Control *>(map_);
+    }
+
+    const Control &GetControl() const noexcept
+    {
+        return *reinterpret_cast<const Control *>(map_);
+    }
+
+    T *Data() noexcept
+    {
+        return reinterpret_cast<T *>(static_cast<char *>(map_) + GetControl().data_offset);
+    }
+
+    const T *Data() const noexcept
+    {
+        return const_cast<SharedVector &>(*this).Data();
+    }
+
+    size_t MappedCapacity() const noexcept
+    {
+        return (mapped_bytes_ - kDataOffset) / sizeof(T);
+    }
+
+    int Protection() const noexcept
+    {
+        return writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+    }
+
+    void Map(size_t bytes) const
+    {
+        void *map = ::mmap(nullptr, bytes, Protection(), MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED)
+        {
+            ThrowSystemError("mmap");
+        }
+        map_ = map;
+        mapped_bytes_ = bytes;
+    }
+
+    void Remap(size_t bytes) const
+    {
+#ifdef __linux__
+        void *map = ::mremap(map_, mapped_bytes_, bytes, MREMAP_MAYMOVE);
+        if (map == MAP_FAILED)
+        {
+            ThrowSystemError("mremap");
+        }
+        map_ = map;
+        mapped_bytes_ = bytes;
+#else
+        void *old_map = map_;
+        const size_t old_bytes = mapped_bytes_;
+        Map(bytes);
+        ::munmap(old_map, old_bytes);
+#endif
+    }
+
+    void Close() noexcept
+    {
+        if (map_ != nullptr)
+        {
+            ::munmap(map_, mapped_bytes_);
+            map_ = nullptr;
+            mapped_bytes_ = 0;
+        }
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    // Читатель переотображает сегмент внутри константного Read
+    mutable void *map_ = nullptr;
+    mutable size_t mapped_bytes_ = 0;
+    bool writable_ = false;
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// Устойчивая ссылка на элемент SlotMap: номер ячейки и её поколение.
+// Поколение ячейки растёт при каждом удалении, поэтому ссылка на удалённый элемент
+// не совпадёт с новым элементом, занявшим ту же ячейку
+struct SlotMapHandle
+{
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool operator==(const SlotMapHandle &rhs) const noexcept
+    {
+        return index == rhs.index && generation == rhs.generation;
+    }
+
+    bool operator!=(const SlotMapHandle &rhs) const noexcept
+    {
+        return !(*this == rhs);
+    }
+};
+
+// Контейнер с O(1) вставкой, удалением и доступом по устойчивым ссылкам.
+// Элементы лежат плотно в Vector<T> и перебираются с его скоростью; удаление переносит
+// последний элемент на место удалённого. Ссылка указывает не на элемент, а на ячейку
+// разреженного массива, которая хранит текущую позицию элемента в плотном массиве,
+// поэтому ссылки переживают и перестановку, и перевыделение памяти.
+// Свободные ячейки связаны в список через то же поле позиции.
+template <typename T>
+class SlotMap
+{
+    struct Slot
+    {
+        // Позиция в плотном массиве для занятой ячейки, следующая свободная — для свободной
+        uint32_t index;
+        uint32_t generation;
+    };
+
+public:
+    using Handle = SlotMapHandle;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    size_t Size() const noexcept
+    {
+        return values_.Size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return values_.Size() == 0;
+    }
+
+    void Reserve(size_t capacity)
+    {
+        values_.Reserve(capacity);
+        dense_to_slot_.Reserve(capacity);
+        slots_.Reserve(capacity);
+    }
+
+    template <typename... Args>
+    Handle Emplace(Args &&...args)
+    {
+        const size_t dense = values_.Size();
+        if (dense == SlotMapHandle::kInvalidIndex)
+        {
+            throw std::length_error("SlotMap: too many elements");
+        }
+        if (free_head_ == SlotMapHandle::kInvalidIndex)
+        {
+            // Новая ячейка сразу попадает в список свободных: при исключении ниже она не теряется
+            slots_.PushBack(Slot{SlotMapHandle::kInvalidIndex, 0});
+            free_head_ = static_cast<uint32_t>(slots_.Size() - 1);
+        }
+        const uint32_t slot_index = free_head_;
+
+        values_.EmplaceBack(std::forward<Args>(args)...);
+        try
+        {
+            dense_to_slot_.PushBack(slot_index);
+        }
+        catch (...)
+        {
+            values_.PopBack();
+            throw;
+        }
+
+        Slot &slot = slots_[slot_index];
+        free_head_ = slot.index;
+        slot.index = static_cast<uint32_t>(dense);
+        return Handle{slot_index, slot.generation};
+    }
+
+    Handle Insert(const T &value)
+    {
+        return Emplace(value);
+    }
+
+    Handle Insert(T &&value)
+    {
+        return Emplace(std::move(value));
+    }
+
+    bool Contains(Handle handle) const noexcept
+    {
+        return handle.index < slots_.Size() && slots_[handle.index].generation == handle.generation &&
+               IsOccupied(handle.index);
+    }
+
+    // Элемент по ссылке или nullptr, если он удалён
+    T *Get(Handle handle) noexcept
+    {
+        return Contains(handle) ? &values_[slots_[handle.index].index] : nullptr;
+    }
+
+    const T *Get(Handle handle) const noexcept
+    {
+        return const_cast<SlotMap &>(*this).Get(handle);
+    }
+
+    T &operator[](Handle handle) noexcept
+    {
+        assert(Contains(handle));
+        return values_[slots_[handle.index].index];
+    }
+
+    const T &operator[](Handle handle) const noexcept
+    {
+        return const_cast<SlotMap &>(*this)[handle];
+    }
+
+    bool Erase(Handle handle)
+    {
+        if (!Contains(handle))
+        {
+            return false;
+        }
+        Slot &slot = slots_[handle.index];
+        const uint32_t dense = slot.index;
+        const uint32_t moved_slot = dense_to_slot_[values_.Size() - 1];
+
+        values_.EraseUnordered(values_.begin() + dense);
+        dense_to_slot_.EraseUnordered(dense_to_slot_.begin() + dense);
+        // Последний элемент переехал на место удалённого
+        slots_[moved_slot].index = dense;
+
+        ++slot.generation;
+        slot.index = free_head_;
+        free_head_ = handle.index;
+        return true;
+    }
+
+    // Ссылка на элемент с позицией dense в плотном массиве
+    Handle HandleAt(size_t dense) const noexcept
+    {
+        assert(dense < Size());
+        const uint32_t slot_index = dense_to_slot_[dense];
+        return Handle{slot_index, slots_[slot_index].generation};
+    }
+
+    void Clear()
+    {
+        for (size_t dense = 0; dense < values_.Size(); ++dense)
+        {
+            const uint32_t slot_index = dense_to_slot_[dense];
+            Slot &slot = slots_[slot_index];
+            ++slot.generation;
+            slot.index = free_head_;
+            free_head_ = slot_index;
+        }
+        values_.Erase(values_.begin(), values_.end());
+        dense_to_slot_.Erase(dense_to_slot_.begin(), dense_to_slot_.end());
+    }
+
+    // Плотный перебор в порядке хранения; порядок меняется при удалениях
+    iterator begin() noexcept
+    {
+        return values_.begin();
+    }
+
+    iterator end() noexcept
+    {
+        return values_.end();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return values_.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return values_.end();
+    }
+
+    const Vector<T> &Values() const noexcept
+    {
+        return values_;
+    }
+
+private:
+    // Свободная ячейка может указывать на живую позицию плотного массива, поэтому
+    // занятость проверяется обратной ссылкой
+    bool IsOccupied(uint32_t slot_index) const noexcept
+    {
+        const uint32_t dense = slots_[slot_index].index;
+        return dense < dense_to_slot_.Size() && dense_to_slot_[dense] == slot_index;
+    }
+
+    Vector<T> values_;
+    Vector<uint32_t> dense_to_slot_;
+    Vector<Slot> slots_;
+    uint32_t free_head_ = SlotMapHandle::kInvalidIndex;
+};
@@ -0,0 +1,501 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Вектор шириной в один указатель: размер и вместимость хранятся в заголовке блока
+// перед элементами. Пустой вектор указывает на общий статический заголовок и ничего
+// не выделяет, поэтому миллионы пустых векторов внутри других структур стоят по 8 байт
+// вместо 24 у Vector. Цена — Size() и Capacity() читают память по указателю.
+//
+// Интерфейс совпадает с Vector, кроме статистики, записи операций и выражений vector_expr.h
+template <typename T>
+class ThinVector
+{
+    struct Header
+    {
+        size_t size;
+        size_t capacity;
+    };
+
+    // Блок заголовка выровнен под T, так что элементы начинаются сразу за ним
+    struct alignas(std::max(alignof(Header), alignof(T))) HeaderBlock
+    {
+        Header header;
+    };
+
+    static constexpr size_t kAlign = alignof(HeaderBlock);
+    static constexpr size_t kDataOffset = sizeof(HeaderBlock);
+
+public:
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    ThinVector() = default;
+
+    explicit ThinVector(size_t size)
+    {
+        if (size == 0)
+        {
+            return;
+        }
+        Header *header = Allocate(size);
+        try
+        {
+            std::uninitialized_value_construct_n(DataOf(header), size);
+        }
+        catch (...)
+        {
+            Deallocate(header);
+            throw;
+        }
+        header->size = size;
+        header_ = header;
+    }
+
+    ThinVector(const ThinVector &other)
+    {
+        const size_t size = other.Size();
+        if (size == 0)
+        {
+            return;
+        }
+        Header *header = Allocate(size);
+        try
+        {
+            std::uninitialized_copy_n(other.begin(), size, DataOf(header));
+        }
+        catch (...)
+        {
+            Deallocate(header);
+            throw;
+        }
+        header->size = size;
+        header_ = header;
+    }
+
+    ThinVector(ThinVector &&other) noexcept
+        : header_(std::exchange(other.header_, Empty()))
+    {
+    }
+
+    ThinVector &operator=(const ThinVector &rhs)
+    {
+        if (this == &rhs)
+        {
+            return *this;
+        }
+        const size_t rhs_size = rhs.Size();
+        if (rhs_size > Capacity())
+        {
+            ThinVector rhs_copy(rhs);
+            Swap(rhs_copy);
+            return *this;
+        }
+        if (Capacity() == 0)
+        {
+            // Оба пусты, а общий заголовок менять нельзя
+            return *this;
+        }
+
+        const size_t size = Size();
+        if (rhs_size >= size)
+        {
+            std::copy_n(rhs.begin(), size, begin());
+            std::uninitialized_copy_n(rhs.begin() + size, rhs_size - size, begin() + size);
+        }
+        else
+        {
+            std::copy_n(rhs.begin(), rhs_size, begin());
+            std::destroy_n(begin() + rhs_size, size - rhs_size);
+        }
+        header_->size = rhs_size;
+        return *this;
+    }
+
+    ThinVector &operator=(ThinVector &&rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            ThinVector tmp(std::move(rhs));
+            Swap(tmp);
+        }
+        return *this;
+    }
+
+    ~ThinVector()
+    {
+        std::destroy_n(begin(), Size());
+        Deallocate(header_);
+    }
+
+    iterator begin() noexcept
+    {
+        return DataOf(header_);
+    }
+    iterator end() noexcept
+    {
+        return begin() + Size();
+    }
+    const_iterator begin() const noexcept
+    {
+        return DataOf(header_);
+    }
+    const_iterator end() const noexcept
+    {
+        return begin() + Size();
+    }
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    size_t Size() const noexcept
+    {
+        return header_->size;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return header_->capacity;
+    }
+
+    const T &operator[](size_t index) const noexcept
+    {
+        return const_cast<ThinVector &>(*this)[index];
+    }
+
+    T &operator[](size_t index) noexcept
+    {
+        assert(index < Size());
+        return begin()[index];
+    }
+
+    void Reserve(size_t new_capacity)
+    {
+        if (new_capacity <= Capacity())
+        {
+            return;
+        }
+        const size_t size = Size();
+        Header *header = Allocate(new_capacity);
+        try
+        {
+            Relocate(begin(), size, DataOf(header), size);
+        }
+        catch (...)
+        {
+            Deallocate(header);
+            throw;
+        }
+        Replace(header, size);
+    }
+
+    void Resize(size_t new_size)
+    {
+        const size_t size = Size();
+        if (new_size == size)
+        {
+            return;
+        }
+        if (new_size < size)
+        {
+            std::destroy_n(begin() + new_size, size - new_size);
+            header_->size = new_size;
+            return;
+        }
+        Reserve(new_size);
+        std::uninitialized_value_construct_n(begin() + size, new_size - size);
+        header_->size = new_size;
+    }
+
+    template <typename... Args>
+    T &EmplaceBack(Args &&...args)
+    {
+        const size_t size = Size();
+        if (size == Capacity())
+        {
+            GrowAndEmplace(size, std::forward<Args>(args)...);
+        }
+        else
+        {
+            new (begin() + size) T(std::forward<Args>(args)...);
+            header_->size = size + 1;
+        }
+        return begin()[size];
+    }
+
+    void PushBack(const T &value)
+    {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T &&value)
+    {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args &&...args)
+    {
+        const size_t index = static_cast<size_t>(pos - cbegin());
+        const size_t size = Size();
+        if (size == Capacity())
+        {
+            GrowAndEmplace(index, std::forward<Args>(args)...);
+        }
+        else if (index == size)
+        {
+            new (end()) T(std::forward<Args>(args)...);
+            header_->size = size + 1;
+        }
+        else
+        {
+            // Значение создаётся до сдвига: аргументы могут ссылаться на элементы самого вектора
+            T value(std::forward<Args>(args)...);
+            new (end()) T(std::move(*(end() - 1)));
+            header_->size = size + 1;
+            std::move_backward(begin() + index, begin() + size - 1, begin() + size);
+            begin()[index] = std::move(value);
+        }
+        return begin() + index;
+    }
+
+    iterator Insert(const_iterator pos, const T &value)
+    {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T &&value)
+    {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos)
+    {
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет диапазон [first, last) за один сдвиг хвоста
+    iterator Erase(const_iterator first, const_iterator last)
+    {
+        const size_t index = static_cast<size_t>(first - cbegin());
+        const size_t count = static_cast<size_t>(last - first);
+        if (count == 0)
+        {
+            return begin() + index;
+        }
+        std::move(begin() + index + count, end(), begin() + index);
+        std::destroy_n(end() - count, count);
+        header_->size -= count;
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, для которых pred вернул true, сохраняя порядок остальных.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred)
+    {
+        T *buf = begin();
+        const size_t size = Size();
+        size_t kept = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (!pred(std::as_const(buf[i])))
+            {
+                if (kept != i)
+                {
+                    buf[kept] = std::move(buf[i]);
+                }
+                ++kept;
+            }
+        }
+        const size_t erased = size - kept;
+        if (erased != 0)
+        {
+            std::destroy_n(buf + kept, erased);
+            header_->size = kept;
+        }
+        return erased;
+    }
+
+    // Удаление без сохранения порядка: на место pos перемещается последний элемент
+    iterator EraseUnordered(const_iterator pos)
+    {
+        const size_t index = static_cast<size_t>(pos - cbegin());
+        if (index + 1 != Size())
+        {
+            begin()[index] = std::move(*(end() - 1));
+        }
+        PopBack();
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, для которых pred вернул true, не сохраняя порядок.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t EraseUnorderedIf(Predicate pred)
+    {
+        const size_t old_size = Size();
+        size_t i = 0;
+        while (i < Size())
+        {
+            if (pred(std::as_const(begin()[i])))
+            {
+                // Перенесённый с конца элемент тоже нужно проверить, поэтому i не растёт
+                EraseUnordered(cbegin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        return old_size - Size();
+    }
+
+    void PopBack()
+    {
+        assert(Size() != 0);
+        (end() - 1)->~T();
+        --header_->size;
+    }
+
+    void Swap(ThinVector &other) noexcept
+    {
+        std::swap(header_, other.header_);
+    }
+
+private:
+    // Общий заголовок пустых векторов. Он константный и лежит в памяти только для чтения,
+    // так что случайная запись в него сразу падает
+    static inline const HeaderBlock kEmpty{};
+
+    static Header *Empty() noexcept
+    {
+        return const_cast<Header *>(&kEmpty.header);
+    }
+
+    static T *DataOf(Header *header) noexcept
+    {
+        return reinterpret_cast<T *>(reinterpret_cast<char *>(header) + kDataOffset);
+    }
+
+    static const T *DataOf(const Header *header) noexcept
+    {
+        return DataOf(const_cast<Header *>(header));
+    }
+
+    // Выделяет блок с заголовком под capacity > 0 элементов; размер в заголовке — 0
+    static Header *Allocate(size_t capacity)
+    {
+        if (capacity > (std::numeric_limits<size_t>::max() - kDataOffset) / sizeof(T))
+        {
+            throw std::length_error("ThinVector: capacity is too large");
+        }
+        const size_t bytes = kDataOffset + capacity * sizeof(T);
+        void *memory;
+        if constexpr (kAlign > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            memory = operator new(bytes, std::align_val_t(kAlign));
+        }
+        else
+        {
+            memory = operator new(bytes);
+        }
+        return new (memory) Header{0, capacity};
+    }
+
+    // Освобождает блок; общий заголовок пустых векторов не трогает
+    static void Deallocate(Header *header) noexcept
+    {
+        if (header == Empty())
+        {
+            return;
+        }
+        if constexpr (kAlign > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            operator delete(header, std::align_val_t(kAlign));
+        }
+        else
+        {
+            operator delete(header);
+        }
+    }
+
+    // Переносит size элементов из from в to, оставляя свободной позицию gap (gap == size — без дыры).
+    // Перемещает, если перемещение не бросает исключений, иначе копирует, чтобы при исключении
+    // исходные элементы остались нетронутыми
+    static void Relocate(T *from, size_t size, T *to, size_t gap)
+    {
+        const auto transfer = [](T *first, size_t n, T *dest) {
+            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
+            {
+                std::uninitialized_move_n(first, n, dest);
+            }
+            else
+            {
+                std::uninitialized_copy_n(first, n, dest);
+            }
+        };
+        transfer(from, gap, to);
+        try
+        {
+            transfer(from + gap, size - gap, to + gap + 1);
+        }
+        catch (...)
+        {
+            std::destroy_n(to, gap);
+            throw;
+        }
+    }
+
+    // Переносит элементы в новый блок удвоенной вместимости, создавая новый элемент в позиции index.
+    // Новый элемент создаётся первым: аргументы могут ссылаться на элементы самого вектора
+    template <typename... Args>
+    void GrowAndEmplace(size_t index, Args &&...args)
+    {
+        const size_t size = Size();
+        Header *header = Allocate(size == 0 ? 1 : 2 * size);
+        T *data = DataOf(header);
+        try
+        {
+            new (data + index) T(std::forward<Args>(args)...);
+            try
+            {
+                Relocate(begin(), size, data, index);
+            }
+            catch (...)
+            {
+                data[index].~T();
+                throw;
+            }
+        }
+        catch (...)
+        {
+            Deallocate(header);
+            throw;
+        }
+        Replace(header, size + 1);
+    }
+
+    // Разрушает текущие элементы и переходит на header, в котором уже size элементов
+    void Replace(Header *header, size_t size) noexcept
+    {
+        std::destroy_n(begin(), Size());
+        Deallocate(header_);
+        header->size = size;
+        header_ = header;
+    }
+
+    Header *header_ = Empty();
+};
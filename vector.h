@@ -1,19 +1,46 @@
 #pragma once
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <memory>
 #include <algorithm>
 
-template <typename T>
+#include "vector_record.h"
+#include "vector_stats.h"
+
+// Источник памяти RawMemory по умолчанию: operator new и operator delete.
+// Другой источник (ArenaAllocator из vector_arena.h) передаётся параметром шаблона Allocator
+// и должен предоставлять те же Allocate и Deallocate
+struct HeapAllocator
+{
+    void *Allocate(size_t bytes, size_t /*alignment*/) const
+    {
+        return operator new(bytes);
+    }
+
+    void Deallocate(void *buf, size_t /*bytes*/, size_t /*alignment*/) const noexcept
+    {
+        operator delete(buf);
+    }
+};
+
+// SizeType — тип хранимой вместимости. С uint32_t заголовок Vector занимает 16 байт вместо 24.
+// Allocator хранится в каждом экземпляре; пустой HeapAllocator места не занимает
+template <typename T, typename SizeType = size_t, typename Allocator = HeapAllocator>
 class RawMemory
 {
+    static_assert(std::is_integral_v<SizeType> && std::is_unsigned_v<SizeType>, "SizeType must be an unsigned integer");
+
 public:
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity)), capacity_(capacity)
+    explicit RawMemory(size_t capacity, const Allocator &allocator = Allocator())
+        : allocator_(allocator), buffer_(Allocate(capacity)), capacity_(static_cast<SizeType>(capacity))
     {
     }
 
@@ -21,25 +48,26 @@ public:
     RawMemory &operator=(const RawMemory &rhs) = delete;
 
     RawMemory(RawMemory &&other) noexcept
-        : buffer_{std::exchange(other.buffer_, nullptr)},
+        : allocator_(other.allocator_),
+          buffer_{std::exchange(other.buffer_, nullptr)},
           capacity_{std::exchange(other.capacity_, 0)}
     {
     }
 
+    // Память и её источник переходят вместе
     RawMemory &operator=(RawMemory &&rhs) noexcept
     {
         if (this != &rhs)
         {
             Swap(rhs);
-            Deallocate(rhs.buffer_);
-            rhs.capacity_ = 0;
+            rhs.Release();
         }
         return *this;
     }
 
     ~RawMemory()
     {
-        Deallocate(buffer_);
+        Release();
     }
 
     T *operator+(size_t offset) noexcept
@@ -67,10 +95,16 @@ public:
 
     void Swap(RawMemory &other) noexcept
     {
+        std::swap(allocator_, other.allocator_);
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
+    const Allocator &GetAllocator() const noexcept
+    {
+        return allocator_;
+    }
+
     const T *GetAddress() const noexcept
     {
         return buffer_;
@@ -86,25 +120,51 @@ public:
         return capacity_;
     }
 
+    // Наибольшая вместимость: помещается в SizeType, а размер в байтах — в size_t
+    static constexpr size_t MaxCapacity() noexcept
+    {
+        return std::min<size_t>(std::numeric_limits<SizeType>::max(), std::numeric_limits<size_t>::max() / sizeof(T));
+    }
+
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T *Allocate(size_t n)
+    // Выделяет сырую память под n элементов и возвращает указатель на неё.
+    // Бросает std::length_error, если n больше MaxCapacity()
+    T *Allocate(size_t n)
     {
-        return n != 0 ? static_cast<T *>(operator new(n * sizeof(T))) : nullptr;
+        if (n > MaxCapacity())
+        {
+            throw std::length_error("RawMemory: capacity exceeds the size type");
+        }
+        return n != 0 ? static_cast<T *>(allocator_.Allocate(n * sizeof(T), alignof(T))) : nullptr;
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T *buf) noexcept
+    // Возвращает буфер источнику и оставляет RawMemory пустой
+    void Release() noexcept
     {
-        operator delete(buf);
+        if (buffer_ != nullptr)
+        {
+            allocator_.Deallocate(buffer_, capacity_ * sizeof(T), alignof(T));
+        }
+        buffer_ = nullptr;
+        capacity_ = 0;
     }
 
+    [[no_unique_address]] Allocator allocator_;
     T *buffer_ = nullptr;
-    size_t capacity_ = 0;
+    SizeType capacity_ = 0;
 };
 
-template <typename T>
-class Vector
+// Ленивое выражение над векторами, определено в vector_expr.h
+template <typename E>
+class VectorExpr;
+
+// Без VECTOR_ENABLE_STATS и VECTOR_ENABLE_RECORDING базы пустые и не занимают места.
+// Vector<T, uint32_t> хранит размер и вместимость в 32 битах и занимает 16 байт;
+// рост сверх 2^32 - 1 элементов бросает std::length_error.
+// Источник памяти переходит с данными при перемещении и обмене и сохраняется при
+// присваивании копированием; копия берёт источник оригинала
+template <typename T, typename SizeType = size_t, typename Allocator = HeapAllocator>
+class Vector : private vector_stats::Instance, private vector_record::Instance
 {
 public:
     using iterator = T *;
@@ -112,33 +172,64 @@ public:
 
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size), size_(size) //
+    explicit Vector(const Allocator &allocator)
+        : data_(0, allocator) //
+    {
+    }
+
+    explicit Vector(size_t size, const Allocator &allocator = Allocator())
+        : data_(size, allocator), size_(static_cast<SizeType>(size)) //
     {
+        RecordOp(vector_record::Op::Resize, sizeof(T), 0, 0, size);
         std::uninitialized_value_construct_n(data_.GetAddress(), size);
     }
 
     Vector(const Vector &other)
-        : data_(other.size_), size_(other.size_) //
+        : vector_stats::Instance(), vector_record::Instance(), data_(other.size_, other.data_.GetAllocator()),
+          size_(other.size_) //
     {
+        RecordPair(vector_record::Op::CopyConstruct, sizeof(T), 0, 0, other, other.size_, other.Capacity());
         std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
     }
 
     Vector(Vector &&other) noexcept
         : data_{std::move(other.data_)}, size_{other.size_}
     {
+        // other уже опустошён: его прежнее состояние теперь наше
+        RecordPair(vector_record::Op::MoveConstruct, sizeof(T), 0, 0, other, size_, Capacity());
         other.size_ = 0;
     }
 
+    // Вычисляет выражение из vector_expr.h за один проход без временных векторов
+    template <typename E>
+    Vector(const VectorExpr<E> &expr)
+        : data_(expr.Size()), size_(static_cast<SizeType>(expr.Size())) //
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Vector expressions are defined for numeric types only");
+        RecordOp(vector_record::Op::Resize, sizeof(T), 0, 0, size_);
+        const E &e = expr.Self();
+        T *buf = data_.GetAddress();
+        for (size_t i = 0; i < size_; ++i)
+        {
+            new (buf + i) T(e[i]);
+        }
+    }
+
     Vector &operator=(const Vector &rhs)
     {
         if (this == &rhs)
             return (*this);
 
+        RecordPair(vector_record::Op::CopyAssign, sizeof(T), size_, Capacity(), rhs, rhs.size_, rhs.Capacity());
         if (rhs.size_ > data_.Capacity())
         {
-            Vector rhs_copy(rhs);
-            Swap(rhs_copy);
+            // Новый буфер берётся из нашего источника памяти, а не из источника rhs
+            vector_stats::GrowthEvent growth(*this, data_.Capacity(), rhs.size_, 0, vector_stats::Element<T>());
+            RawMemory<T, SizeType, Allocator> new_data(rhs.size_, data_.GetAllocator());
+            std::uninitialized_copy_n(rhs.data_.GetAddress(), rhs.size_, new_data.GetAddress());
+            std::destroy_n(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+            size_ = rhs.size_;
         }
         else
         {
@@ -168,12 +259,47 @@ public:
         if (this == &rhs)
             return (*this);
 
+        RecordPair(vector_record::Op::MoveAssign, sizeof(T), size_, Capacity(), rhs, rhs.size_, rhs.Capacity());
+        // Прежние элементы разрушаются здесь, rhs остаётся пустым с нашим буфером
+        std::destroy_n(data_.GetAddress(), size_);
         data_.Swap(rhs.data_);
         size_ = rhs.size_;
         rhs.size_ = 0;
         return *this;
     }
 
+    // Вычисляет выражение на месте, если хватает вместимости. Выражение может
+    // ссылаться на сам вектор: i-й элемент результата зависит только от i-х элементов операндов
+    template <typename E>
+    Vector &operator=(const VectorExpr<E> &expr)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Vector expressions are defined for numeric types only");
+        const size_t new_size = expr.Size();
+        Record(vector_record::Op::Resize, new_size);
+        const E &e = expr.Self();
+        if (new_size > data_.Capacity())
+        {
+            // Выражение читает старый буфер, поэтому результат строится в новом из нашего источника памяти
+            RawMemory<T, SizeType, Allocator> new_data(new_size, data_.GetAllocator());
+            T *buf = new_data.GetAddress();
+            for (size_t i = 0; i < new_size; ++i)
+            {
+                new (buf + i) T(e[i]);
+            }
+            data_.Swap(new_data);
+        }
+        else
+        {
+            T *buf = data_.GetAddress();
+            for (size_t i = 0; i < new_size; ++i)
+            {
+                new (buf + i) T(e[i]);
+            }
+        }
+        size_ = static_cast<SizeType>(new_size);
+        return *this;
+    }
+
     iterator begin() noexcept
     {
         return data_.GetAddress();
@@ -201,6 +327,8 @@ public:
 
     void Resize(size_t new_size)
     {
+        Record(vector_record::Op::Resize, new_size);
+        vector_record::Suppress suppress;
         if (new_size == size_)
         {
             return;
@@ -217,15 +345,18 @@ public:
         auto diff = new_size - size_;
         Reserve(new_size);
         std::uninitialized_value_construct_n(data_.GetAddress() + size_, diff);
-        size_ = new_size;
+        size_ = static_cast<SizeType>(new_size);
     }
 
     template <typename... Args>
     T &EmplaceBack(Args &&...args)
     {
+        Record(vector_record::Op::EmplaceBack);
         if (size_ == data_.Capacity())
         {
-            RawMemory<T> new_data((size_ == 0) ? 1 : 2 * size_);
+            const size_t new_capacity = GrowthCapacity();
+            vector_stats::GrowthEvent growth(*this, data_.Capacity(), new_capacity, size_, vector_stats::Element<T>());
+            RawMemory<T, SizeType, Allocator> new_data(new_capacity, data_.GetAllocator());
 
             new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
             if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
@@ -253,11 +384,14 @@ public:
     iterator Emplace(const_iterator pos, Args&&... args)
     {
         std::size_t index = std::distance(cbegin(), pos);
+        Record(vector_record::Op::Emplace, index);
 
         if (size_ == data_.Capacity())
         {
             std::size_t index_to_end = std::distance(pos, cend());
-            RawMemory<T> new_data((size_ == 0) ? 1 : 2 * size_);
+            const size_t new_capacity = GrowthCapacity();
+            vector_stats::GrowthEvent growth(*this, data_.Capacity(), new_capacity, size_, vector_stats::Element<T>());
+            RawMemory<T, SizeType, Allocator> new_data(new_capacity, data_.GetAllocator());
             new(new_data.GetAddress() + index)T(std::forward<Args>(args)...);
             if constexpr (std::is_nothrow_move_constructible_v<T> || 
                             !std::is_copy_constructible_v<T>) 
@@ -321,9 +455,11 @@ public:
         else
         {
             if (size_ != index) {
-                new (end()) T(std::forward<T>(*(end() - 1)));
+                // Значение создаётся до сдвига: аргументы могут ссылаться на элементы самого вектора
+                T value(std::forward<Args>(args)...);
+                new (end()) T(std::move(*(end() - 1)));
                 std::move_backward(begin() + index, end() - 1, end());
-                data_[index] = T(std::forward<Args>(args)...);
+                data_[index] = std::move(value);
             } else {
                 new (begin() + index) T(std::forward<Args>(args)...);
             }
@@ -335,6 +471,7 @@ public:
     iterator Erase(const_iterator pos)
     {
         auto index = std::distance(cbegin(), pos);
+        Record(vector_record::Op::Erase, index, 1);
         std::move(begin() + index + 1, end(), begin() + index);
         std::destroy_n(end()-1, 1);
         --size_;
@@ -342,6 +479,113 @@ public:
         return begin() + index;
     }
 
+    // Удаляет диапазон [first, last) за один сдвиг хвоста
+    iterator Erase(const_iterator first, const_iterator last)
+    {
+        auto index = std::distance(cbegin(), first);
+        auto count = static_cast<size_t>(std::distance(first, last));
+        Record(vector_record::Op::Erase, index, count);
+        if (count == 0)
+        {
+            return begin() + index;
+        }
+
+        T *dst = begin() + index;
+        const size_t tail = size_ - index - count;
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            std::memmove(static_cast<void *>(dst), static_cast<const void *>(dst + count), tail * sizeof(T));
+        }
+        else
+        {
+            std::move(dst + count, end(), dst);
+        }
+        std::destroy_n(end() - count, count);
+        size_ -= count;
+
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, для которых pred вернул true, сохраняя порядок остальных.
+    // Один проход уплотнения, хвост разрушается один раз.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred)
+    {
+        T *buf = data_.GetAddress();
+        size_t kept = 0;
+        if constexpr (std::is_trivially_copyable_v<T>)
+        {
+            // Запись без ветвления: элемент копируется всегда, а счётчик растёт только для оставляемых
+            for (size_t i = 0; i < size_; ++i)
+            {
+                const bool erase = pred(std::as_const(buf[i]));
+                buf[kept] = buf[i];
+                kept += !erase;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < size_; ++i)
+            {
+                if (!pred(std::as_const(buf[i])))
+                {
+                    if (kept != i)
+                    {
+                        buf[kept] = std::move(buf[i]);
+                    }
+                    ++kept;
+                }
+            }
+        }
+
+        // Удалённые позиции в трассе не нужны: для воспроизведения хватает нового размера
+        Record(vector_record::Op::Resize, kept);
+        const size_t erased = size_ - kept;
+        std::destroy_n(buf + kept, erased);
+        size_ = kept;
+        return erased;
+    }
+
+    // Удаление без сохранения порядка: на место pos перемещается последний элемент.
+    // Стоит O(1) и ровно одно перемещающее присваивание (если pos не последний)
+    iterator EraseUnordered(const_iterator pos)
+    {
+        auto index = std::distance(cbegin(), pos);
+        Record(vector_record::Op::EraseUnordered, index);
+        vector_record::Suppress suppress;
+        if (static_cast<size_t>(index) + 1 != size_)
+        {
+            data_[index] = std::move(data_[size_ - 1]);
+        }
+        PopBack();
+
+        return begin() + index;
+    }
+
+    // Удаляет все элементы, для которых pred вернул true, не сохраняя порядок.
+    // Каждое удаление стоит не более одного перемещающего присваивания.
+    // Возвращает количество удалённых элементов
+    template <typename Predicate>
+    size_t EraseUnorderedIf(Predicate pred)
+    {
+        const size_t old_size = size_;
+        size_t i = 0;
+        while (i < size_)
+        {
+            if (pred(std::as_const(data_[i])))
+            {
+                // Перенесённый с конца элемент тоже нужно проверить, поэтому i не растёт
+                EraseUnordered(cbegin() + i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        return old_size - size_;
+    }
+
     iterator Insert(const_iterator pos, const T& value)
     {
         return Emplace(pos, value);
@@ -354,9 +598,12 @@ public:
 
     void PushBack(const T &value)
     {
+        Record(vector_record::Op::EmplaceBack);
         if (size_ == Capacity())
         {
-            RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+            const size_t new_capacity = GrowthCapacity();
+            vector_stats::GrowthEvent growth(*this, data_.Capacity(), new_capacity, size_, vector_stats::Element<T>());
+            RawMemory<T, SizeType, Allocator> new_data(new_capacity, data_.GetAllocator());
             new (new_data + size_) T(value);
             if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
             {
@@ -378,9 +625,12 @@ public:
 
     void PushBack(T &&value)
     {
+        Record(vector_record::Op::EmplaceBack);
         if (size_ == Capacity())
         {
-            RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+            const size_t new_capacity = GrowthCapacity();
+            vector_stats::GrowthEvent growth(*this, data_.Capacity(), new_capacity, size_, vector_stats::Element<T>());
+            RawMemory<T, SizeType, Allocator> new_data(new_capacity, data_.GetAllocator());
             new (new_data + size_) T(std::move(value));
             if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
             {
@@ -402,12 +652,14 @@ public:
 
     void PopBack()
     {
+        Record(vector_record::Op::PopBack);
         data_[size_ - 1].~T();
         size_--;
     }
 
     void Swap(Vector &other) noexcept
     {
+        RecordPair(vector_record::Op::Swap, sizeof(T), size_, Capacity(), other, other.size_, other.Capacity());
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
@@ -422,6 +674,11 @@ public:
         return data_.Capacity();
     }
 
+    const Allocator &GetAllocator() const noexcept
+    {
+        return data_.GetAllocator();
+    }
+
     const T &operator[](size_t index) const noexcept
     {
         return const_cast<Vector &>(*this)[index];
@@ -435,11 +692,13 @@ public:
 
     void Reserve(size_t new_capacity)
     {
+        Record(vector_record::Op::Reserve, new_capacity);
         if (new_capacity <= data_.Capacity())
         {
             return;
         }
-        RawMemory<T> new_data(new_capacity);
+        vector_stats::GrowthEvent growth(*this, data_.Capacity(), new_capacity, size_, vector_stats::Element<T>());
+        RawMemory<T, SizeType, Allocator> new_data(new_capacity, data_.GetAllocator());
         if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>)
         {
             std::uninitialized_move_n(data_.GetAddress(), size_, new_data.GetAddress());
@@ -453,12 +712,44 @@ public:
         data_.Swap(new_data);
     }
 
+    // Счётчики роста экземпляра; без VECTOR_ENABLE_STATS заполнена только wasted_bytes
+    VectorStats Stats() const noexcept
+    {
+        VectorStats stats = Counters();
+        stats.wasted_bytes = (data_.Capacity() - size_) * sizeof(T);
+        return stats;
+    }
+
     ~Vector()
     {
+        RecordDestroy();
+        OnDestroy(data_.Capacity() * sizeof(T), size_ * sizeof(T));
         std::destroy_n(data_.GetAddress(), size_);
     }
 
 private:
+    // Вместимость при росте на один элемент: удвоение, но не больше RawMemory::MaxCapacity().
+    // Бросает std::length_error, если размер уже достиг предела SizeType
+    size_t GrowthCapacity() const
+    {
+        constexpr size_t kMax = RawMemory<T, SizeType, Allocator>::MaxCapacity();
+        if (size_ >= kMax)
+        {
+            throw std::length_error("Vector: size exceeds the size type");
+        }
+        if (size_ == 0)
+        {
+            return 1;
+        }
+        return size_ > kMax / 2 ? kMax : 2 * static_cast<size_t>(size_);
+    }
+
+    // Операция над этим вектором для трассы vector_record; состояние — до операции
+    void Record(vector_record::Op op, uint64_t arg0 = 0, uint64_t arg1 = 0) const
+    {
+        RecordOp(op, sizeof(T), size_, data_.Capacity(), arg0, arg1);
+    }
+
     // Выделяет сырую память под n элементов и возвращает указатель на неё
     static T *Allocate(size_t n)
     {
@@ -484,6 +775,7 @@ private:
     }
 
 private:
-    RawMemory<T> data_;
-    size_t size_ = 0;
+    // С 32-битным SizeType размер занимает хвостовое выравнивание RawMemory, и вектор укладывается в 16 байт
+    [[no_unique_address]] RawMemory<T, SizeType, Allocator> data_;
+    SizeType size_ = 0;
 };
@@ -0,0 +1,213 @@
+#pragma once
+#include "vector.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Арена для множества мелких векторов: память выдаётся сдвигом указателя внутри крупных
+// блоков, и все блоки освобождаются разом — в Reset или вместе с ареной. Освобождение
+// отдельного буфера ничего не стоит; если буфер последний выданный, его место
+// возвращается арене.
+//
+//     VectorArena arena;
+//     Vector<ArenaVector<int>> rows;
+//     rows.EmplaceBack(arena).PushBack(1);
+//
+// Внутри VectorArenaScope векторы, созданные без явной арены (например, в rows.Resize(n)),
+// берут память из арены этой области. Арена должна пережить свои векторы; она не потокобезопасна
+class VectorArena
+{
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit VectorArena(size_t block_size = kDefaultBlockSize)
+        : block_size_(block_size)
+    {
+    }
+
+    VectorArena(const VectorArena &) = delete;
+    VectorArena &operator=(const VectorArena &) = delete;
+
+    ~VectorArena()
+    {
+        FreeBlocks();
+    }
+
+    void *Allocate(size_t bytes, size_t alignment)
+    {
+        const uintptr_t start = AlignUp(reinterpret_cast<uintptr_t>(top_), alignment);
+        const uintptr_t end = reinterpret_cast<uintptr_t>(end_);
+        if (start > end || bytes > end - start)
+        {
+            return AllocateSlow(bytes, alignment);
+        }
+        top_ = reinterpret_cast<char *>(start + bytes);
+        bytes_used_ += bytes;
+        return reinterpret_cast<void *>(start);
+    }
+
+    // Место возвращается, только если буфер был выдан последним
+    void Deallocate(void *buf, size_t bytes) noexcept
+    {
+        char *start = static_cast<char *>(buf);
+        if (start + bytes == top_)
+        {
+            top_ = start;
+            bytes_used_ -= bytes;
+        }
+    }
+
+    // Освобождает все блоки. Векторы, выделившие память из арены, после этого использовать нельзя
+    void Reset() noexcept
+    {
+        FreeBlocks();
+        top_ = nullptr;
+        end_ = nullptr;
+        bytes_used_ = 0;
+        bytes_reserved_ = 0;
+    }
+
+    // Выдано векторам, включая брошенные при росте буферы
+    size_t BytesUsed() const noexcept
+    {
+        return bytes_used_;
+    }
+
+    // Занято блоками у системы
+    size_t BytesReserved() const noexcept
+    {
+        return bytes_reserved_;
+    }
+
+    // Арена из ближайшей VectorArenaScope этого потока или nullptr
+    static VectorArena *&Current() noexcept
+    {
+        thread_local VectorArena *current = nullptr;
+        return current;
+    }
+
+private:
+    struct alignas(std::max_align_t) Block
+    {
+        Block *next;
+    };
+
+    static uintptr_t AlignUp(uintptr_t address, size_t alignment) noexcept
+    {
+        return (address + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    }
+
+    char *NewBlock(size_t data_bytes)
+    {
+        if (data_bytes > std::numeric_limits<size_t>::max() - sizeof(Block))
+        {
+            throw std::bad_alloc();
+        }
+        Block *block = static_cast<Block *>(operator new(sizeof(Block) + data_bytes));
+        block->next = head_;
+        head_ = block;
+        bytes_reserved_ += sizeof(Block) + data_bytes;
+        return reinterpret_cast<char *>(block + 1);
+    }
+
+    // Крупный запрос получает собственный блок, чтобы не бросать остаток текущего
+    void *AllocateSlow(size_t bytes, size_t alignment)
+    {
+        const size_t padding = alignment > alignof(Block) ? alignment - 1 : 0;
+        if (bytes > std::numeric_limits<size_t>::max() - padding)
+        {
+            throw std::bad_alloc();
+        }
+        if (bytes + padding > block_size_ / 4)
+        {
+            char *data = NewBlock(bytes + padding);
+            bytes_used_ += bytes;
+            return reinterpret_cast<void *>(AlignUp(reinterpret_cast<uintptr_t>(data), alignment));
+        }
+        char *data = NewBlock(block_size_);
+        top_ = data;
+        end_ = data + block_size_;
+        return Allocate(bytes, alignment);
+    }
+
+    void FreeBlocks() noexcept
+    {
+        while (head_ != nullptr)
+        {
+            operator delete(std::exchange(head_, head_->next));
+        }
+    }
+
+    size_t block_size_;
+    Block *head_ = nullptr;
+    char *top_ = nullptr;
+    char *end_ = nullptr;
+    size_t bytes_used_ = 0;
+    size_t bytes_reserved_ = 0;
+};
+
+// Источник памяти Vector из арены; хранит указатель на неё
+class ArenaAllocator
+{
+public:
+    // Без явной арены берётся арена текущей VectorArenaScope
+    ArenaAllocator() noexcept
+        : arena_(VectorArena::Current())
+    {
+    }
+
+    ArenaAllocator(VectorArena &arena) noexcept
+        : arena_(&arena)
+    {
+    }
+
+    void *Allocate(size_t bytes, size_t alignment) const
+    {
+        if (arena_ == nullptr)
+        {
+            throw std::logic_error("ArenaAllocator: no arena given and no VectorArenaScope is active");
+        }
+        return arena_->Allocate(bytes, alignment);
+    }
+
+    void Deallocate(void *buf, size_t bytes, size_t /*alignment*/) const noexcept
+    {
+        arena_->Deallocate(buf, bytes);
+    }
+
+    VectorArena *Arena() const noexcept
+    {
+        return arena_;
+    }
+
+private:
+    VectorArena *arena_;
+};
+
+template <typename T, typename SizeType = size_t>
+using ArenaVector = Vector<T, SizeType, ArenaAllocator>;
+
+// Делает арену текущей для векторов, создаваемых в этом потоке без явной арены
+class VectorArenaScope
+{
+public:
+    explicit VectorArenaScope(VectorArena &arena) noexcept
+        : previous_(std::exchange(VectorArena::Current(), &arena))
+    {
+    }
+
+    ~VectorArenaScope()
+    {
+        VectorArena::Current() = previous_;
+    }
+
+    VectorArenaScope(const VectorArenaScope &) = delete;
+    VectorArenaScope &operator=(const VectorArenaScope &) = delete;
+
+private:
+    VectorArena *previous_;
+};
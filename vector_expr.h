@@ -0,0 +1,421 @@
+#pragma once
+#include "vector.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+
+// Поэлементная арифметика над Vector<T> на шаблонах выражений.
+// Операторы + - * /, унарный минус, Abs, Sqrt и Fma не вычисляют ничего сами,
+// а строят дерево выражения. Присваивание дерева вектору (или создание вектора из него)
+// выполняет один цикл без промежуточных выделений памяти:
+//
+//     Vector<double> a = b * k + c;   // один проход по b и c
+//     a = Fma(a, b, 1.0);             // на месте, без реаллокации
+//
+// Узлы хранят операнды-векторы по указателю, поэтому выражение нельзя
+// вычислять после разрушения векторов, из которых оно построено.
+
+// Базовый класс узлов выражения (CRTP)
+template <typename E>
+class VectorExpr
+{
+public:
+    const E &Self() const noexcept
+    {
+        return static_cast<const E &>(*this);
+    }
+
+    size_t Size() const noexcept
+    {
+        return Self().Size();
+    }
+
+    auto operator[](size_t index) const
+    {
+        return Self()[index];
+    }
+};
+
+namespace vector_expr
+{
+    // Лист: ссылка на элементы вектора
+    template <typename T>
+    class Ref : public VectorExpr<Ref<T>>
+    {
+    public:
+        using value_type = T;
+
+        template <typename SizeType, typename Allocator>
+        explicit Ref(const Vector<T, SizeType, Allocator> &v) noexcept
+            : data_(v.begin()), size_(v.Size())
+        {
+        }
+
+        size_t Size() const noexcept
+        {
+            return size_;
+        }
+
+        T operator[](size_t index) const noexcept
+        {
+            return data_[index];
+        }
+
+    private:
+        const T *data_;
+        size_t size_;
+    };
+
+    // Лист: скаляр, размноженный на все позиции. Собственного размера не имеет
+    template <typename T>
+    class Scalar
+    {
+    public:
+        using value_type = T;
+
+        explicit Scalar(T value) noexcept
+            : value_(value)
+        {
+        }
+
+        T operator[](size_t /*index*/) const noexcept
+        {
+            return value_;
+        }
+
+    private:
+        T value_;
+    };
+
+    template <typename X>
+    struct IsScalar : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct IsScalar<Scalar<T>> : std::true_type
+    {
+    };
+
+    // Размер узла с несколькими операндами: берётся у первого операнда, не являющегося скаляром
+    template <typename First, typename... Rest>
+    size_t CommonSize(const First &first, const Rest &...rest) noexcept
+    {
+        if constexpr (IsScalar<First>::value)
+        {
+            return CommonSize(rest...);
+        }
+        else
+        {
+            return first.Size();
+        }
+    }
+
+    template <typename Op, typename E>
+    class Unary : public VectorExpr<Unary<Op, E>>
+    {
+    public:
+        using value_type = std::decay_t<decltype(Op{}(std::declval<typename E::value_type>()))>;
+
+        explicit Unary(const E &e)
+            : e_(e)
+        {
+        }
+
+        size_t Size() const noexcept
+        {
+            return e_.Size();
+        }
+
+        value_type operator[](size_t index) const
+        {
+            return Op{}(e_[index]);
+        }
+
+    private:
+        E e_;
+    };
+
+    template <typename Op, typename L, typename R>
+    class Binary : public VectorExpr<Binary<Op, L, R>>
+    {
+    public:
+        using value_type = std::decay_t<decltype(Op{}(std::declval<typename L::value_type>(),
+                                                      std::declval<typename R::value_type>()))>;
+
+        Binary(const L &l, const R &r)
+            : l_(l), r_(r)
+        {
+            if constexpr (!IsScalar<L>::value && !IsScalar<R>::value)
+            {
+                assert(l_.Size() == r_.Size());
+            }
+        }
+
+        size_t Size() const noexcept
+        {
+            return CommonSize(l_, r_);
+        }
+
+        value_type operator[](size_t index) const
+        {
+            return Op{}(l_[index], r_[index]);
+        }
+
+    private:
+        L l_;
+        R r_;
+    };
+
+    // a * b + c одним узлом. Инструкцию FMA компилятор подставляет сам при -ffp-contract=fast
+    // и подходящем -march; std::fma здесь не используется, так как без аппаратной поддержки
+    // он вызывает библиотечную функцию и не векторизуется
+    template <typename A, typename B, typename C>
+    class MulAdd : public VectorExpr<MulAdd<A, B, C>>
+    {
+    public:
+        using value_type = std::decay_t<decltype(std::declval<typename A::value_type>() * std::declval<typename B::value_type>() +
+                                                 std::declval<typename C::value_type>())>;
+
+        MulAdd(const A &a, const B &b, const C &c)
+            : a_(a), b_(b), c_(c)
+        {
+            if constexpr (!IsScalar<A>::value && !IsScalar<B>::value)
+            {
+                assert(a_.Size() == b_.Size());
+            }
+            if constexpr (!IsScalar<A>::value && !IsScalar<C>::value)
+            {
+                assert(a_.Size() == c_.Size());
+            }
+            if constexpr (!IsScalar<B>::value && !IsScalar<C>::value)
+            {
+                assert(b_.Size() == c_.Size());
+            }
+        }
+
+        size_t Size() const noexcept
+        {
+            return CommonSize(a_, b_, c_);
+        }
+
+        value_type operator[](size_t index) const
+        {
+            return a_[index] * b_[index] + c_[index];
+        }
+
+    private:
+        A a_;
+        B b_;
+        C c_;
+    };
+
+    struct Plus
+    {
+        template <typename L, typename R>
+        auto operator()(L l, R r) const noexcept
+        {
+            return l + r;
+        }
+    };
+
+    struct Minus
+    {
+        template <typename L, typename R>
+        auto operator()(L l, R r) const noexcept
+        {
+            return l - r;
+        }
+    };
+
+    struct Multiplies
+    {
+        template <typename L, typename R>
+        auto operator()(L l, R r) const noexcept
+        {
+            return l * r;
+        }
+    };
+
+    struct Divides
+    {
+        template <typename L, typename R>
+        auto operator()(L l, R r) const noexcept
+        {
+            return l / r;
+        }
+    };
+
+    struct Negate
+    {
+        template <typename X>
+        auto operator()(X x) const noexcept
+        {
+            return -x;
+        }
+    };
+
+    struct Absolute
+    {
+        template <typename X>
+        X operator()(X x) const noexcept
+        {
+            if constexpr (std::is_unsigned_v<X>)
+            {
+                return x;
+            }
+            else
+            {
+                return x < X{} ? -x : x;
+            }
+        }
+    };
+
+    struct SquareRoot
+    {
+        template <typename X>
+        auto operator()(X x) const noexcept
+        {
+            return std::sqrt(x);
+        }
+    };
+
+    // Операнд выражения: вектор с числовыми элементами или узел выражения
+    template <typename X>
+    struct IsVectorOperand : std::is_base_of<VectorExpr<X>, X>
+    {
+    };
+
+    template <typename T, typename SizeType, typename Allocator>
+    struct IsVectorOperand<Vector<T, SizeType, Allocator>> : std::is_arithmetic<T>
+    {
+    };
+
+    template <typename X>
+    inline constexpr bool kIsVectorOperand = IsVectorOperand<std::decay_t<X>>::value;
+
+    template <typename X>
+    inline constexpr bool kIsOperand = kIsVectorOperand<X> || std::is_arithmetic_v<std::decay_t<X>>;
+
+    // Хотя бы один операнд должен быть вектором, иначе операторы перехватили бы арифметику скаляров
+    template <typename... Xs>
+    inline constexpr bool kAreOperands = (kIsOperand<Xs> && ...) && (kIsVectorOperand<Xs> || ...);
+
+    template <typename T, typename SizeType, typename Allocator>
+    Ref<T> AsNode(const Vector<T, SizeType, Allocator> &v) noexcept
+    {
+        return Ref<T>(v);
+    }
+
+    template <typename E>
+    const E &AsNode(const VectorExpr<E> &e) noexcept
+    {
+        return e.Self();
+    }
+
+    // Тип элементов операнда-вектора
+    template <typename X>
+    using VectorValueType = typename std::decay_t<decltype(AsNode(std::declval<const X &>()))>::value_type;
+
+    // Тип элементов первого операнда-вектора среди Xs
+    template <bool IsVector, typename X, typename... Rest>
+    struct FirstVectorValueImpl
+    {
+        using type = VectorValueType<X>;
+    };
+
+    template <typename X, typename Next, typename... Rest>
+    struct FirstVectorValueImpl<false, X, Next, Rest...>
+        : FirstVectorValueImpl<kIsVectorOperand<Next>, Next, Rest...>
+    {
+    };
+
+    template <typename X, typename... Rest>
+    struct FirstVectorValue : FirstVectorValueImpl<kIsVectorOperand<X>, X, Rest...>
+    {
+    };
+
+    // Узел для операнда. Скаляры приводятся к типу элементов вектора из того же выражения,
+    // чтобы Vector<float> * 2.0 считался во float
+    template <typename Value, typename X>
+    auto MakeNode(const X &x)
+    {
+        if constexpr (std::is_arithmetic_v<X>)
+        {
+            return Scalar<Value>(static_cast<Value>(x));
+        }
+        else
+        {
+            return AsNode(x);
+        }
+    }
+
+    template <typename Op, typename L, typename R>
+    auto MakeBinary(const L &l, const R &r)
+    {
+        using Value = typename FirstVectorValue<L, R>::type;
+        auto ln = MakeNode<Value>(l);
+        auto rn = MakeNode<Value>(r);
+        return Binary<Op, decltype(ln), decltype(rn)>(ln, rn);
+    }
+
+} // namespace vector_expr
+
+template <typename L, typename R, typename = std::enable_if_t<vector_expr::kAreOperands<L, R>>>
+auto operator+(const L &l, const R &r)
+{
+    return vector_expr::MakeBinary<vector_expr::Plus>(l, r);
+}
+
+template <typename L, typename R, typename = std::enable_if_t<vector_expr::kAreOperands<L, R>>>
+auto operator-(const L &l, const R &r)
+{
+    return vector_expr::MakeBinary<vector_expr::Minus>(l, r);
+}
+
+template <typename L, typename R, typename = std::enable_if_t<vector_expr::kAreOperands<L, R>>>
+auto operator*(const L &l, const R &r)
+{
+    return vector_expr::MakeBinary<vector_expr::Multiplies>(l, r);
+}
+
+template <typename L, typename R, typename = std::enable_if_t<vector_expr::kAreOperands<L, R>>>
+auto operator/(const L &l, const R &r)
+{
+    return vector_expr::MakeBinary<vector_expr::Divides>(l, r);
+}
+
+template <typename X, typename = std::enable_if_t<vector_expr::kIsVectorOperand<X>>>
+auto operator-(const X &x)
+{
+    auto node = vector_expr::AsNode(x);
+    return vector_expr::Unary<vector_expr::Negate, decltype(node)>(node);
+}
+
+template <typename X, typename = std::enable_if_t<vector_expr::kIsVectorOperand<X>>>
+auto Abs(const X &x)
+{
+    auto node = vector_expr::AsNode(x);
+    return vector_expr::Unary<vector_expr::Absolute, decltype(node)>(node);
+}
+
+// Квадратный корень. Цикл векторизуется только с -fno-math-errno,
+// иначе компилятор сохраняет проверку отрицательного аргумента для errno
+template <typename X, typename = std::enable_if_t<vector_expr::kIsVectorOperand<X>>>
+auto Sqrt(const X &x)
+{
+    auto node = vector_expr::AsNode(x);
+    return vector_expr::Unary<vector_expr::SquareRoot, decltype(node)>(node);
+}
+
+// a * b + c поэлементно; любые операнды, кроме всех сразу, могут быть скалярами
+template <typename A, typename B, typename C, typename = std::enable_if_t<vector_expr::kAreOperands<A, B, C>>>
+auto Fma(const A &a, const B &b, const C &c)
+{
+    using Value = typename vector_expr::FirstVectorValue<A, B, C>::type;
+    auto an = vector_expr::MakeNode<Value>(a);
+    auto bn = vector_expr::MakeNode<Value>(b);
+    auto cn = vector_expr::MakeNode<Value>(c);
+    return vector_expr::MulAdd<decltype(an), decltype(bn), decltype(cn)>(an, bn, cn);
+}
@@ -0,0 +1,369 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef VECTOR_ENABLE_RECORDING
+#include <atomic>
+#include <cerrno>
+#include <mutex>
+#include <string>
+#include <system_error>
+#endif
+
+// Запись последовательности операций над Vector в компактную двоичную трассу для
+// воспроизведения в bench/replay_bench.cpp. Включается макросом VECTOR_ENABLE_RECORDING;
+// без него база Vector пустая, а хуки ничего не делают.
+//
+// Запись идёт только между Start и Stop. Экземпляр получает номер при первой записанной
+// операции; если он был создан до Start, в трассу сначала попадает Adopt с его текущим
+// размером и вместимостью. Значения элементов не пишутся — только размер элемента.
+//
+// Формат: магическая строка kMagic, затем записи «код операции (1 байт), аргументы
+// в LEB128». Все потоки пишут в один файл под мьютексом, так что порядок операций
+// над общими векторами сохраняется.
+namespace vector_record
+{
+    enum class Op : uint8_t
+    {
+        Adopt,          // id, element_size, size, capacity
+        Destroy,        // id
+        EmplaceBack,    // id
+        Emplace,        // id, index
+        Erase,          // id, index, count
+        EraseUnordered, // id, index
+        PopBack,        // id
+        Reserve,        // id, capacity
+        Resize,         // id, size
+        CopyConstruct,  // dst, src
+        CopyAssign,     // dst, src
+        MoveConstruct,  // dst, src
+        MoveAssign,     // dst, src
+        Swap,           // id, other
+        Count,
+    };
+
+    inline constexpr char kMagic[8] = {'V', 'E', 'C', 'R', 'E', 'C', '1', '\0'};
+
+    // Число аргументов у каждой операции
+    inline constexpr uint8_t kArity[static_cast<size_t>(Op::Count)] = {4, 1, 1, 2, 3, 2, 1, 2, 2, 2, 2, 2, 2, 2};
+
+    inline const char *OpName(Op op) noexcept
+    {
+        static const char *const kNames[static_cast<size_t>(Op::Count)] = {
+            "Adopt",   "Destroy", "EmplaceBack",   "Emplace",    "Erase",         "EraseUnordered", "PopBack",
+            "Reserve", "Resize",  "CopyConstruct", "CopyAssign", "MoveConstruct", "MoveAssign",     "Swap"};
+        return op < Op::Count ? kNames[static_cast<size_t>(op)] : "?";
+    }
+
+    struct Event
+    {
+        Op op = Op::Count;
+        uint64_t args[4] = {};
+    };
+
+#ifdef VECTOR_ENABLE_RECORDING
+    inline constexpr bool kEnabled = true;
+
+    class Recorder
+    {
+    public:
+        static Recorder &Instance()
+        {
+            static Recorder *recorder = new Recorder();
+            return *recorder;
+        }
+
+        bool Active() const noexcept
+        {
+            return active_.load(std::memory_order_relaxed);
+        }
+
+        // Номер текущего сеанса записи; экземпляры из прошлых сеансов заново проходят Adopt
+        uint64_t Session() const noexcept
+        {
+            return session_.load(std::memory_order_relaxed);
+        }
+
+        uint64_t NextId() noexcept
+        {
+            return next_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+        }
+
+        void Start(const std::string &path)
+        {
+            std::lock_guard lock(mutex_);
+            if (file_ != nullptr)
+            {
+                throw std::logic_error("vector_record: recording is already started");
+            }
+            file_ = std::fopen(path.c_str(), "wb");
+            if (file_ == nullptr)
+            {
+                throw std::system_error(errno, std::generic_category(), "vector_record: cannot open " + path);
+            }
+            used_ = 0;
+            Append(kMagic, sizeof(kMagic));
+            session_.fetch_add(1, std::memory_order_relaxed);
+            active_.store(true, std::memory_order_release);
+        }
+
+        void Stop()
+        {
+            std::lock_guard lock(mutex_);
+            if (file_ == nullptr)
+            {
+                return;
+            }
+            active_.store(false, std::memory_order_release);
+            Flush();
+            const bool failed = std::ferror(file_) != 0;
+            const bool close_failed = std::fclose(file_) != 0;
+            file_ = nullptr;
+            if (failed || close_failed)
+            {
+                throw std::runtime_error("vector_record: failed to write the trace");
+            }
+        }
+
+        void Write(Op op, const uint64_t *args)
+        {
+            std::lock_guard lock(mutex_);
+            if (file_ == nullptr)
+            {
+                return;
+            }
+            if (used_ + kMaxRecord > sizeof(buffer_))
+            {
+                Flush();
+            }
+            buffer_[used_++] = static_cast<char>(op);
+            for (size_t i = 0; i < kArity[static_cast<size_t>(op)]; ++i)
+            {
+                for (uint64_t value = args[i];; value >>= 7)
+                {
+                    const bool last = value < 0x80;
+                    buffer_[used_++] = static_cast<char>((value & 0x7F) | (last ? 0 : 0x80));
+                    if (last)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+    private:
+        // Код и до четырёх аргументов по 10 байт
+        static constexpr size_t kMaxRecord = 1 + 4 * 10;
+
+        void Append(const char *data, size_t size)
+        {
+            std::memcpy(buffer_ + used_, data, size);
+            used_ += size;
+        }
+
+        void Flush()
+        {
+            std::fwrite(buffer_, 1, used_, file_);
+            used_ = 0;
+        }
+
+        std::mutex mutex_;
+        std::FILE *file_ = nullptr;
+        std::atomic<bool> active_{false};
+        std::atomic<uint64_t> session_{0};
+        std::atomic<uint64_t> next_id_{0};
+        char buffer_[1 << 16];
+        size_t used_ = 0;
+    };
+
+    // Внутри операции, которая сама вызывает другие операции (Resize через Reserve,
+    // EraseUnordered через PopBack), вложенные вызовы не записываются
+    inline int &SuppressDepth() noexcept
+    {
+        thread_local int depth = 0;
+        return depth;
+    }
+
+    class Suppress
+    {
+    public:
+        Suppress() noexcept
+        {
+            ++SuppressDepth();
+        }
+
+        ~Suppress()
+        {
+            --SuppressDepth();
+        }
+
+        Suppress(const Suppress &) = delete;
+        Suppress &operator=(const Suppress &) = delete;
+    };
+
+    inline bool ShouldRecord() noexcept
+    {
+        return Recorder::Instance().Active() && SuppressDepth() == 0;
+    }
+
+    inline void Start(const std::string &path)
+    {
+        Recorder::Instance().Start(path);
+    }
+
+    inline void Stop()
+    {
+        Recorder::Instance().Stop();
+    }
+
+    // Номер экземпляра в трассе; база Vector
+    class Instance
+    {
+    public:
+        Instance() = default;
+
+        // Копия — новый экземпляр со своим номером
+        Instance(const Instance &) noexcept
+        {
+        }
+
+        Instance &operator=(const Instance &) noexcept
+        {
+            return *this;
+        }
+
+    protected:
+        ~Instance() = default;
+
+        // Записывает операцию над собой; size и capacity — состояние до операции
+        void RecordOp(Op op, size_t element_size, size_t size, size_t capacity, uint64_t arg0 = 0,
+                      uint64_t arg1 = 0) const
+        {
+            if (ShouldRecord())
+            {
+                const uint64_t args[4] = {Id(element_size, size, capacity), arg0, arg1, 0};
+                Recorder::Instance().Write(op, args);
+            }
+        }
+
+        // Операция с другим экземпляром: копирование, перемещение, обмен.
+        // Для конструкторов self только что создан и Adopt не нужен
+        void RecordPair(Op op, size_t element_size, size_t size, size_t capacity, const Instance &other,
+                        size_t other_size, size_t other_capacity) const
+        {
+            if (!ShouldRecord())
+            {
+                return;
+            }
+            const bool constructed = op == Op::CopyConstruct || op == Op::MoveConstruct;
+            if (constructed)
+            {
+                id_ = Recorder::Instance().NextId();
+                session_ = Recorder::Instance().Session();
+            }
+            const uint64_t other_id = other.Id(element_size, other_size, other_capacity);
+            const uint64_t args[4] = {constructed ? id_ : Id(element_size, size, capacity), other_id, 0, 0};
+            Recorder::Instance().Write(op, args);
+        }
+
+        void RecordDestroy() const
+        {
+            // Экземпляры, не попавшие в текущий сеанс, в трассе не существуют
+            if (id_ != 0 && session_ == Recorder::Instance().Session() && ShouldRecord())
+            {
+                const uint64_t args[4] = {id_, 0, 0, 0};
+                Recorder::Instance().Write(Op::Destroy, args);
+            }
+        }
+
+    private:
+        uint64_t Id(size_t element_size, size_t size, size_t capacity) const
+        {
+            const uint64_t session = Recorder::Instance().Session();
+            if (id_ == 0 || session_ != session)
+            {
+                id_ = Recorder::Instance().NextId();
+                session_ = session;
+                const uint64_t args[4] = {id_, element_size, size, capacity};
+                Recorder::Instance().Write(Op::Adopt, args);
+            }
+            return id_;
+        }
+
+        mutable uint64_t id_ = 0;
+        mutable uint64_t session_ = 0;
+    };
+
+#else
+    inline constexpr bool kEnabled = false;
+
+    class Suppress
+    {
+    public:
+        Suppress() noexcept
+        {
+        }
+    };
+
+    class Instance
+    {
+    protected:
+        void RecordOp(Op, size_t, size_t, size_t, uint64_t = 0, uint64_t = 0) const noexcept
+        {
+        }
+
+        void RecordPair(Op, size_t, size_t, size_t, const Instance &, size_t, size_t) const noexcept
+        {
+        }
+
+        void RecordDestroy() const noexcept
+        {
+        }
+    };
+#endif
+
+    // Читает трассу и вызывает fn(const Event &) для каждой записи.
+    // Бросает std::runtime_error на повреждённом файле
+    template <typename F>
+    void ReadTrace(std::FILE *file, F &&fn)
+    {
+        char magic[sizeof(kMagic)];
+        if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+            std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+        {
+            throw std::runtime_error("vector_record: not a Vector trace");
+        }
+        for (int code; (code = std::getc(file)) != EOF;)
+        {
+            Event event;
+            event.op = static_cast<Op>(code);
+            if (event.op >= Op::Count)
+            {
+                throw std::runtime_error("vector_record: unknown operation in trace");
+            }
+            for (size_t i = 0; i < kArity[static_cast<size_t>(code)]; ++i)
+            {
+                uint64_t value = 0;
+                for (unsigned shift = 0;; shift += 7)
+                {
+                    const int byte = std::getc(file);
+                    if (byte == EOF || shift > 63)
+                    {
+                        throw std::runtime_error("vector_record: truncated trace");
+                    }
+                    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if ((byte & 0x80) == 0)
+                    {
+                        break;
+                    }
+                }
+                event.args[i] = value;
+            }
+            fn(static_cast<const Event &>(event));
+        }
+    }
+
+} // namespace vector_record
@@ -0,0 +1,460 @@
+#pragma once
+#include "vector.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Двоичный формат Vector<T> для тривиально копируемых T, пригодный для загрузки без копирования.
+//
+// Заголовок (64 байта): магическое число, версия, вид (плоский или вложенный), размер,
+// выравнивание и вид элемента, количество элементов, размер полезной нагрузки и контрольная сумма
+// заголовка (с нулевым полем суммы) и полезной нагрузки.
+// Плоский вектор: элементы сразу после заголовка.
+// Vector<Vector<T>>: таблица из count + 1 смещений (uint64_t, в элементах), затем
+// с границы 64 байт — все строки подряд.
+//
+// Serialize пишет в любой Writer с методом Write(const void *data, size_t size).
+// VectorView проверяет заголовок и отдаёт элементы прямо из переданного буфера.
+
+class SerializationError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+namespace vector_serialize
+{
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t kind;
+        uint32_t element_size;
+        uint32_t alignment;
+        uint64_t count;
+        uint64_t payload_size;
+        uint64_t checksum;
+        uint32_t element_kind;
+        uint8_t reserved[12];
+    };
+
+    inline constexpr uint64_t kMagic = 0x3130524553434556; // "VECSER01"
+    // Версия 2: контрольная сумма покрывает и заголовок
+    inline constexpr uint32_t kVersion = 2;
+    inline constexpr uint32_t kFlat = 0;
+    inline constexpr uint32_t kNested = 1;
+    // Заголовок и начало массива значений выровнены на кэш-линию
+    inline constexpr size_t kAlignment = 64;
+    static_assert(sizeof(Header) == kAlignment);
+
+    // Грубый вид элемента, чтобы не перепутать, например, double и int64_t одного размера
+    template <typename T>
+    constexpr uint32_t ElementKind() noexcept
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return 1;
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            return std::is_signed_v<T> ? 2 : 3;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+    inline constexpr size_t AlignUp(size_t n) noexcept
+    {
+        return (n + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    // Потоковая 64-битная контрольная сумма: четыре независимые дорожки по 8 байт,
+    // чтобы умножения не ждали друг друга. Не криптографическая, ловит повреждения данных
+    class Checksum
+    {
+    public:
+        void Update(const void *data, size_t size) noexcept
+        {
+            if (size == 0)
+            {
+                return;
+            }
+            auto bytes = static_cast<const unsigned char *>(data);
+            total_ += size;
+            if (pending_ != 0)
+            {
+                const size_t take = std::min(size, sizeof(buffer_) - pending_);
+                std::memcpy(buffer_ + pending_, bytes, take);
+                pending_ += take;
+                bytes += take;
+                size -= take;
+                if (pending_ < sizeof(buffer_))
+                {
+                    return;
+                }
+                Block(buffer_);
+                pending_ = 0;
+            }
+            for (; size >= sizeof(buffer_); size -= sizeof(buffer_), bytes += sizeof(buffer_))
+            {
+                Block(bytes);
+            }
+            std::memcpy(buffer_, bytes, size);
+            pending_ = size;
+        }
+
+        uint64_t Finish() const noexcept
+        {
+            uint64_t h = total_ * kPrime;
+            for (const uint64_t lane : lanes_)
+            {
+                h = Mix(h ^ lane);
+            }
+            for (size_t i = 0; i < pending_; ++i)
+            {
+                h = Mix(h ^ buffer_[i]);
+            }
+            return h;
+        }
+
+    private:
+        static constexpr uint64_t kPrime = 0x9e3779b97f4a7c15;
+
+        static uint64_t Mix(uint64_t x) noexcept
+        {
+            x *= kPrime;
+            return x ^ (x >> 29);
+        }
+
+        void Block(const unsigned char *block) noexcept
+        {
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                uint64_t word;
+                std::memcpy(&word, block + lane * sizeof(word), sizeof(word));
+                lanes_[lane] = Mix(lanes_[lane] ^ word);
+            }
+        }
+
+        uint64_t lanes_[4] = {1, 2, 3, 4};
+        unsigned char buffer_[32] = {};
+        size_t pending_ = 0;
+        uint64_t total_ = 0;
+    };
+
+    // Заголовок с нулевой контрольной суммой; её заполняет Serialize после прохода по данным
+    template <typename T>
+    Header MakeHeader(uint32_t kind, uint64_t count, uint64_t payload_size) noexcept
+    {
+        Header header{};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.kind = kind;
+        header.element_size = sizeof(T);
+        header.alignment = alignof(T);
+        header.element_kind = ElementKind<T>();
+        header.count = count;
+        header.payload_size = payload_size;
+        return header;
+    }
+
+    // Начинает контрольную сумму с заголовка, в котором само поле суммы обнулено
+    inline Checksum StartChecksum(Header header) noexcept
+    {
+        header.checksum = 0;
+        Checksum checksum;
+        checksum.Update(&header, sizeof(header));
+        return checksum;
+    }
+
+    // Проверяет заголовок и контрольную сумму, возвращает указатель на начало полезной нагрузки
+    template <typename T>
+    const unsigned char *Validate(const void *data, size_t size, uint32_t kind, bool verify_checksum, Header &header)
+    {
+        static_assert(alignof(T) <= kAlignment);
+        if (size < sizeof(Header))
+        {
+            throw SerializationError("VectorView: buffer is smaller than the header");
+        }
+        if (reinterpret_cast<uintptr_t>(data) % alignof(Header) != 0)
+        {
+            throw SerializationError("VectorView: misaligned buffer");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != kMagic)
+        {
+            throw SerializationError("VectorView: bad magic");
+        }
+        if (header.version != kVersion)
+        {
+            throw SerializationError("VectorView: unsupported version " + std::to_string(header.version));
+        }
+        if (header.kind != kind)
+        {
+            throw SerializationError("VectorView: flat/nested layout mismatch");
+        }
+        if (header.element_size != sizeof(T) || header.alignment != alignof(T) ||
+            header.element_kind != ElementKind<T>())
+        {
+            throw SerializationError("VectorView: element type mismatch");
+        }
+        if (header.payload_size > size - sizeof(Header))
+        {
+            throw SerializationError("VectorView: truncated payload");
+        }
+
+        const auto payload = static_cast<const unsigned char *>(data) + sizeof(Header);
+        if (reinterpret_cast<uintptr_t>(payload) % alignof(T) != 0)
+        {
+            throw SerializationError("VectorView: payload is not aligned for the element type");
+        }
+        if (verify_checksum)
+        {
+            Checksum checksum = StartChecksum(header);
+            checksum.Update(payload, header.payload_size);
+            if (checksum.Finish() != header.checksum)
+            {
+                throw SerializationError("VectorView: checksum mismatch");
+            }
+        }
+        return payload;
+    }
+
+    inline const unsigned char kZeroPadding[kAlignment] = {};
+
+} // namespace vector_serialize
+
+// Буфер в памяти как Writer. Выделенная память выровнена по границе operator new
+class BufferWriter
+{
+public:
+    void Write(const void *data, size_t size)
+    {
+        const size_t old_size = buffer_.Size();
+        // Resize выделяет ровно столько, сколько просят, поэтому рост делаем геометрическим
+        if (old_size + size > buffer_.Capacity())
+        {
+            buffer_.Reserve(std::max(old_size + size, 2 * buffer_.Capacity()));
+        }
+        buffer_.Resize(old_size + size);
+        if (size != 0)
+        {
+            std::memcpy(buffer_.begin() + old_size, data, size);
+        }
+    }
+
+    const char *Data() const noexcept
+    {
+        return buffer_.begin();
+    }
+
+    char *Data() noexcept
+    {
+        return buffer_.begin();
+    }
+
+    size_t Size() const noexcept
+    {
+        return buffer_.Size();
+    }
+
+private:
+    Vector<char> buffer_;
+};
+
+// Размерный тип и источник памяти в формат не входят: записанное читается одним VectorView
+template <typename T, typename SizeType, typename Allocator, typename Writer>
+void Serialize(const Vector<T, SizeType, Allocator> &v, Writer &writer)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be serialized");
+    using namespace vector_serialize;
+
+    const size_t payload_size = v.Size() * sizeof(T);
+    Header header = MakeHeader<T>(kFlat, v.Size(), payload_size);
+    Checksum checksum = StartChecksum(header);
+    checksum.Update(v.begin(), payload_size);
+    header.checksum = checksum.Finish();
+    writer.Write(&header, sizeof(header));
+    writer.Write(v.begin(), payload_size);
+}
+
+template <typename T, typename RowSize, typename RowAllocator, typename SizeType, typename Allocator, typename Writer>
+void Serialize(const Vector<Vector<T, RowSize, RowAllocator>, SizeType, Allocator> &rows, Writer &writer)
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be serialized");
+    using namespace vector_serialize;
+
+    Vector<uint64_t> offsets;
+    offsets.Reserve(rows.Size() + 1);
+    offsets.PushBack(0);
+    for (const auto &row : rows)
+    {
+        offsets.PushBack(offsets[offsets.Size() - 1] + row.Size());
+    }
+
+    const size_t table_size = offsets.Size() * sizeof(uint64_t);
+    // Значения начинаются с границы 64 байт от начала заголовка
+    const size_t padding = AlignUp(sizeof(Header) + table_size) - sizeof(Header) - table_size;
+    const size_t payload_size = table_size + padding + offsets[rows.Size()] * sizeof(T);
+
+    // Контрольная сумма нужна в заголовке, поэтому данные проходятся дважды
+    Header header = MakeHeader<T>(kNested, rows.Size(), payload_size);
+    Checksum checksum = StartChecksum(header);
+    checksum.Update(offsets.begin(), table_size);
+    checksum.Update(kZeroPadding, padding);
+    for (const auto &row : rows)
+    {
+        checksum.Update(row.begin(), row.Size() * sizeof(T));
+    }
+
+    header.checksum = checksum.Finish();
+    writer.Write(&header, sizeof(header));
+    writer.Write(offsets.begin(), table_size);
+    writer.Write(kZeroPadding, padding);
+    for (const auto &row : rows)
+    {
+        writer.Write(row.begin(), row.Size() * sizeof(T));
+    }
+}
+
+// Неизменяемое представление сериализованного Vector<T> поверх чужого буфера.
+// Буфер должен жить дольше представления
+template <typename T>
+class VectorView
+{
+public:
+    using iterator = const T *;
+    using const_iterator = const T *;
+
+    VectorView() = default;
+
+    VectorView(const T *data, size_t size) noexcept
+        : data_(data), size_(size)
+    {
+    }
+
+    // Разбирает буфер, записанный Serialize(const Vector<T>&, ...)
+    static VectorView Load(const void *data, size_t size, bool verify_checksum = true)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be serialized");
+        vector_serialize::Header header;
+        const auto payload = vector_serialize::Validate<T>(data, size, vector_serialize::kFlat, verify_checksum, header);
+        // Без умножения: count * sizeof(T) может переполниться и совпасть с payload_size
+        if (header.payload_size % sizeof(T) != 0 || header.count != header.payload_size / sizeof(T))
+        {
+            throw SerializationError("VectorView: payload size does not match element count");
+        }
+        return VectorView(reinterpret_cast<const T *>(payload), header.count);
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return data_;
+    }
+    const_iterator end() const noexcept
+    {
+        return data_ + size_;
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    const T &operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const T *Data() const noexcept
+    {
+        return data_;
+    }
+
+private:
+    const T *data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Представление сериализованного Vector<Vector<T>>: строки доступны через таблицу смещений
+template <typename T>
+class VectorView<Vector<T>>
+{
+public:
+    VectorView() = default;
+
+    static VectorView Load(const void *data, size_t size, bool verify_checksum = true)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable elements can be serialized");
+        using namespace vector_serialize;
+
+        Header header;
+        const auto payload = Validate<T>(data, size, kNested, verify_checksum, header);
+        if (header.count >= header.payload_size / sizeof(uint64_t))
+        {
+            throw SerializationError("VectorView: offset table does not fit the payload");
+        }
+
+        const size_t table_size = (header.count + 1) * sizeof(uint64_t);
+        const size_t values_offset = AlignUp(sizeof(Header) + table_size) - sizeof(Header);
+        const auto offsets = reinterpret_cast<const uint64_t *>(payload);
+        const uint64_t value_count = offsets[header.count];
+        if (values_offset > header.payload_size ||
+            value_count != (header.payload_size - values_offset) / sizeof(T) ||
+            values_offset + value_count * sizeof(T) != header.payload_size)
+        {
+            throw SerializationError("VectorView: payload size does not match the offset table");
+        }
+        if (offsets[0] != 0)
+        {
+            throw SerializationError("VectorView: corrupted offset table");
+        }
+        for (size_t i = 0; i < header.count; ++i)
+        {
+            if (offsets[i] > offsets[i + 1])
+            {
+                throw SerializationError("VectorView: corrupted offset table");
+            }
+        }
+
+        const auto values = payload + values_offset;
+        if (reinterpret_cast<uintptr_t>(values) % alignof(T) != 0)
+        {
+            throw SerializationError("VectorView: values are not aligned for the element type");
+        }
+
+        VectorView view;
+        view.offsets_ = offsets;
+        view.values_ = reinterpret_cast<const T *>(values);
+        view.size_ = header.count;
+        return view;
+    }
+
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    VectorView<T> operator[](size_t index) const noexcept
+    {
+        assert(index < size_);
+        return VectorView<T>(values_ + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    // Все значения подряд, без деления на строки
+    VectorView<T> Values() const noexcept
+    {
+        return VectorView<T>(values_, size_ == 0 ? 0 : offsets_[size_]);
+    }
+
+private:
+    const uint64_t *offsets_ = nullptr;
+    const T *values_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,400 @@
+#pragma once
+#include "vector.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define VECTOR_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define VECTOR_SIMD_X86 0
+#endif
+
+// Ядра поиска и редукции пишутся как обычные циклы, удобные для автовекторизации.
+// GCC собирает их в нескольких вариантах (AVX-512, AVX2, SSE4.2, базовый),
+// нужный выбирается при первом вызове по возможностям процессора
+#if VECTOR_SIMD_X86 && defined(__GNUC__) && !defined(__clang__) && defined(__ELF__)
+#define VECTOR_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "sse4.2", "default")))
+#else
+#define VECTOR_SIMD_CLONES
+#endif
+
+// Векторные ядра для Vector<T, SizeType, Allocator> с арифметическим T.
+// Набор инструкций выбирается во время выполнения, всегда есть скалярный запасной путь
+namespace vector_simd
+{
+
+#if VECTOR_SIMD_X86
+    inline bool CpuHasAvx2() noexcept
+    {
+        static const bool has = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+        return has;
+    }
+
+    inline bool CpuHasAvx512() noexcept
+    {
+        static const bool has = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("popcnt");
+        return has;
+    }
+#endif
+
+    template <typename T>
+    inline constexpr bool kHasCompactKernel = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                              (sizeof(T) == 4 || sizeof(T) == 8);
+
+    // Уплотняет [from, n) в позицию out без ветвлений: элемент пишется всегда,
+    // а позиция записи сдвигается только для оставляемых. Возвращает новый out
+    template <typename T>
+    size_t CompactNotEqualScalar(T *data, size_t out, size_t from, size_t n, T value) noexcept
+    {
+        for (size_t i = from; i < n; ++i)
+        {
+            const T x = data[i];
+            data[out] = x;
+            out += !(x == value);
+        }
+        return out;
+    }
+
+#if VECTOR_SIMD_X86
+    // Таблицы перестановок для AVX2: по маске оставляемых дорожек — индексы 32-битных слов,
+    // которые нужно собрать в начало регистра
+    template <size_t Lanes>
+    constexpr std::array<std::array<uint32_t, 8>, (1u << Lanes)> MakeCompressTable()
+    {
+        constexpr size_t kWordsPerLane = 8 / Lanes;
+        std::array<std::array<uint32_t, 8>, (1u << Lanes)> table{};
+        for (size_t mask = 0; mask < table.size(); ++mask)
+        {
+            size_t out = 0;
+            for (size_t lane = 0; lane < Lanes; ++lane)
+            {
+                if (mask & (size_t{1} << lane))
+                {
+                    for (size_t w = 0; w < kWordsPerLane; ++w)
+                    {
+                        table[mask][out++] = static_cast<uint32_t>(lane * kWordsPerLane + w);
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    template <size_t Lanes>
+    inline constexpr auto kCompressTable = MakeCompressTable<Lanes>();
+
+    template <typename T>
+    __attribute__((target("avx2,popcnt"))) size_t CompactNotEqualAvx2(T *data, size_t n, T value) noexcept
+    {
+        constexpr size_t kLanes = 32 / sizeof(T);
+        size_t out = 0;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes)
+        {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            unsigned equal;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                equal = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(v), _mm256_set1_ps(value), _CMP_EQ_OQ));
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                equal = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(v), _mm256_set1_pd(value), _CMP_EQ_OQ));
+            }
+            else if constexpr (sizeof(T) == 4)
+            {
+                int32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                equal = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_set1_epi32(bits))));
+            }
+            else
+            {
+                int64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                equal = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, _mm256_set1_epi64x(bits))));
+            }
+
+            const unsigned keep = ~equal & ((1u << kLanes) - 1);
+            const __m256i perm = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kCompressTable<kLanes>[keep].data()));
+            // Запись полного регистра безопасна: out + kLanes <= i + kLanes <= n,
+            // а затираемые элементы блока уже загружены в v
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + out), _mm256_permutevar8x32_epi32(v, perm));
+            out += static_cast<size_t>(__builtin_popcount(keep));
+        }
+        return CompactNotEqualScalar(data, out, i, n, value);
+    }
+
+    template <typename T>
+    __attribute__((target("avx512f,popcnt"))) size_t CompactNotEqualAvx512(T *data, size_t n, T value) noexcept
+    {
+        constexpr size_t kLanes = 64 / sizeof(T);
+        size_t out = 0;
+        size_t i = 0;
+        for (; i + kLanes <= n; i += kLanes)
+        {
+            unsigned keep;
+            if constexpr (std::is_same_v<T, float>)
+            {
+                const __m512 v = _mm512_loadu_ps(data + i);
+                const __mmask16 m = _mm512_cmp_ps_mask(v, _mm512_set1_ps(value), _CMP_NEQ_UQ);
+                _mm512_storeu_ps(data + out, _mm512_maskz_compress_ps(m, v));
+                keep = m;
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                const __m512d v = _mm512_loadu_pd(data + i);
+                const __mmask8 m = _mm512_cmp_pd_mask(v, _mm512_set1_pd(value), _CMP_NEQ_UQ);
+                _mm512_storeu_pd(data + out, _mm512_maskz_compress_pd(m, v));
+                keep = m;
+            }
+            else if constexpr (sizeof(T) == 4)
+            {
+                int32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                const __m512i v = _mm512_loadu_si512(data + i);
+                const __mmask16 m = _mm512_cmpneq_epi32_mask(v, _mm512_set1_epi32(bits));
+                _mm512_storeu_si512(data + out, _mm512_maskz_compress_epi32(m, v));
+                keep = m;
+            }
+            else
+            {
+                int64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                const __m512i v = _mm512_loadu_si512(data + i);
+                const __mmask8 m = _mm512_cmpneq_epi64_mask(v, _mm512_set1_epi64(bits));
+                _mm512_storeu_si512(data + out, _mm512_maskz_compress_epi64(m, v));
+                keep = m;
+            }
+            out += static_cast<size_t>(__builtin_popcount(keep));
+        }
+        return CompactNotEqualScalar(data, out, i, n, value);
+    }
+#endif
+
+    // Размер блока ядер поиска и редукции: два 512-битных регистра
+    template <typename T>
+    inline constexpr size_t kBlockSize = 128 / sizeof(T);
+
+    // Сумма целых копится в 64-битном типе, сумма вещественных — в самом T
+    template <typename T>
+    using SumType = std::conditional_t<std::is_floating_point_v<T>, T,
+                                       std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+    // Беззнаковый счётчик той же ширины, что и T: сравнение и сложение идут в одних дорожках
+    template <typename T>
+    using LaneCounter = std::conditional_t<sizeof(T) == 1, uint8_t,
+                        std::conditional_t<sizeof(T) == 2, uint16_t,
+                        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+    template <typename T>
+    VECTOR_SIMD_CLONES size_t FindKernel(const T *data, size_t n, T value) noexcept
+    {
+        // Блок вдвое длиннее обычного: иначе для 64-битных T цикл разворачивается целиком и не векторизуется
+        constexpr size_t kBlock = 2 * kBlockSize<T>;
+        size_t i = 0;
+        // Блок целиком проверяется без ветвлений, точная позиция ищется только в блоке с совпадением
+        for (; i + kBlock <= n; i += kBlock)
+        {
+            LaneCounter<T> found = 0;
+            for (size_t k = 0; k < kBlock; ++k)
+            {
+                found |= data[i + k] == value;
+            }
+            if (found)
+            {
+                break;
+            }
+        }
+        for (; i < n; ++i)
+        {
+            if (data[i] == value)
+            {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    template <typename T>
+    VECTOR_SIMD_CLONES size_t CountKernel(const T *data, size_t n, T value) noexcept
+    {
+        constexpr size_t kBlock = kBlockSize<T>;
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + kBlock <= n; i += kBlock)
+        {
+            LaneCounter<T> block_count = 0;
+            for (size_t k = 0; k < kBlock; ++k)
+            {
+                block_count += data[i + k] == value;
+            }
+            count += block_count;
+        }
+        for (; i < n; ++i)
+        {
+            count += data[i] == value;
+        }
+        return count;
+    }
+
+    // Для вещественных T порядок сложения отличается от последовательного,
+    // поэтому результат может расходиться с std::accumulate в последних битах
+    template <typename T>
+    VECTOR_SIMD_CLONES SumType<T> SumKernel(const T *data, size_t n) noexcept
+    {
+        constexpr size_t kBlock = kBlockSize<T>;
+        SumType<T> acc[kBlock] = {};
+        size_t i = 0;
+        for (; i + kBlock <= n; i += kBlock)
+        {
+            for (size_t k = 0; k < kBlock; ++k)
+            {
+                acc[k] += data[i + k];
+            }
+        }
+        SumType<T> sum{};
+        for (size_t k = 0; k < kBlock; ++k)
+        {
+            sum += acc[k];
+        }
+        for (; i < n; ++i)
+        {
+            sum += data[i];
+        }
+        return sum;
+    }
+
+    // n > 0. Для вещественных T результат на данных с NaN не определён
+    template <typename T>
+    VECTOR_SIMD_CLONES std::pair<T, T> MinMaxKernel(const T *data, size_t n) noexcept
+    {
+        constexpr size_t kBlock = kBlockSize<T>;
+        T mins[kBlock];
+        T maxs[kBlock];
+        for (size_t k = 0; k < kBlock; ++k)
+        {
+            mins[k] = maxs[k] = data[0];
+        }
+        size_t i = 0;
+        for (; i + kBlock <= n; i += kBlock)
+        {
+            for (size_t k = 0; k < kBlock; ++k)
+            {
+                const T x = data[i + k];
+                mins[k] = x < mins[k] ? x : mins[k];
+                maxs[k] = maxs[k] < x ? x : maxs[k];
+            }
+        }
+        T min = mins[0];
+        T max = maxs[0];
+        for (size_t k = 1; k < kBlock; ++k)
+        {
+            min = mins[k] < min ? mins[k] : min;
+            max = max < maxs[k] ? maxs[k] : max;
+        }
+        for (; i < n; ++i)
+        {
+            min = data[i] < min ? data[i] : min;
+            max = max < data[i] ? data[i] : max;
+        }
+        return {min, max};
+    }
+
+    // Оставляет в начале data элементы, не равные value, в исходном порядке.
+    // Возвращает их количество; содержимое за ним не определено
+    template <typename T>
+    size_t CompactNotEqual(T *data, size_t n, T value) noexcept
+    {
+#if VECTOR_SIMD_X86
+        if constexpr (kHasCompactKernel<T>)
+        {
+            if (CpuHasAvx512())
+            {
+                return CompactNotEqualAvx512(data, n, value);
+            }
+            if (CpuHasAvx2())
+            {
+                return CompactNotEqualAvx2(data, n, value);
+            }
+        }
+#endif
+        return CompactNotEqualScalar(data, 0, 0, n, value);
+    }
+
+} // namespace vector_simd
+
+// Удаляет из v все элементы, равные value, сохраняя порядок остальных.
+// Для арифметических T используется векторное ядро уплотнения.
+// Возвращает количество удалённых элементов
+template <typename T, typename SizeType, typename Allocator>
+size_t EraseValue(Vector<T, SizeType, Allocator> &v, const T &value)
+{
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        const size_t old_size = v.Size();
+        v.Resize(vector_simd::CompactNotEqual(v.begin(), old_size, value));
+        return old_size - v.Size();
+    }
+    else
+    {
+        return v.EraseIf([&value](const T &elem) {
+            return elem == value;
+        });
+    }
+}
+
+// Векторизованные аналоги std::find, std::count, std::accumulate и std::minmax_element
+// для Vector<T> с арифметическим T
+
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+typename Vector<T, SizeType, Allocator>::const_iterator Find(const Vector<T, SizeType, Allocator> &v, T value) noexcept
+{
+    return v.begin() + vector_simd::FindKernel(v.begin(), v.Size(), value);
+}
+
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+typename Vector<T, SizeType, Allocator>::iterator Find(Vector<T, SizeType, Allocator> &v, T value) noexcept
+{
+    return v.begin() + vector_simd::FindKernel(v.begin(), v.Size(), value);
+}
+
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+bool Contains(const Vector<T, SizeType, Allocator> &v, T value) noexcept
+{
+    return Find(v, value) != v.end();
+}
+
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+size_t Count(const Vector<T, SizeType, Allocator> &v, T value) noexcept
+{
+    return vector_simd::CountKernel(v.begin(), v.Size(), value);
+}
+
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+vector_simd::SumType<T> Sum(const Vector<T, SizeType, Allocator> &v) noexcept
+{
+    return vector_simd::SumKernel(v.begin(), v.Size());
+}
+
+// Пара (минимум, максимум). Вектор не должен быть пустым
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+std::pair<T, T> MinMax(const Vector<T, SizeType, Allocator> &v) noexcept
+{
+    assert(v.Size() != 0);
+    return vector_simd::MinMaxKernel(v.begin(), v.Size());
+}
+
+// Индекс первого минимального элемента. Вектор не должен быть пустым
+template <typename T, typename SizeType, typename Allocator, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+size_t ArgMin(const Vector<T, SizeType, Allocator> &v) noexcept
+{
+    assert(v.Size() != 0);
+    // Два векторных прохода быстрее одного скалярного с отслеживанием индекса
+    const T min = vector_simd::MinMaxKernel(v.begin(), v.Size()).first;
+    return vector_simd::FindKernel(v.begin(), v.Size(), min);
+}
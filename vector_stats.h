@@ -0,0 +1,442 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Трассировке нужны те же события роста
+#if defined(VECTOR_ENABLE_TRACING) && !defined(VECTOR_ENABLE_STATS)
+#define VECTOR_ENABLE_STATS
+#endif
+
+#ifdef VECTOR_ENABLE_STATS
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#endif
+
+#ifdef VECTOR_ENABLE_TRACING
+#include "vector_trace.h"
+#endif
+
+// Статистика роста Vector. Включается макросом VECTOR_ENABLE_STATS; без него все хуки
+// пустые, а база Vector — пустой класс, так что ни размер вектора, ни код не меняются.
+//
+// Каждый экземпляр считает свои перевыделения и приписывается месту создания —
+// активной в этот момент в потоке VectorStatsScope (или месту «unscoped»).
+// Места собраны в общем реестре, который выгружается в JSON:
+//
+//     VectorStatsScope scope("router");  // __FILE__:__LINE__ подставляются сами
+//     ...
+//     vector_stats::DumpJson(std::cerr);
+//
+// С VECTOR_ENABLE_TRACING каждое событие роста ещё и пишется в трассу, см. vector_trace.h
+
+// Снимок счётчиков одного экземпляра
+struct VectorStats
+{
+    uint64_t reallocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t bytes_relocated = 0;
+    uint64_t peak_capacity_bytes = 0;
+    // Ёмкость сверх размера на момент снимка
+    uint64_t wasted_bytes = 0;
+    // Моменты первого и последнего роста, нс по steady_clock
+    uint64_t first_growth_ns = 0;
+    uint64_t last_growth_ns = 0;
+};
+
+namespace vector_stats
+{
+    // Тип элемента вектора для события роста
+    template <typename T>
+    struct Element
+    {
+    };
+
+#ifdef VECTOR_ENABLE_STATS
+    inline constexpr bool kEnabled = true;
+
+    // Читаемое имя типа без RTTI, из сигнатуры функции
+    template <typename T>
+    const char *TypeName()
+    {
+        static const std::string name = [signature = std::string_view(__PRETTY_FUNCTION__)] {
+            const size_t begin = signature.find("T = ");
+            if (begin == std::string_view::npos)
+            {
+                return std::string(signature);
+            }
+            const size_t end = signature.find_first_of(";]", begin);
+            return std::string(signature.substr(begin + 4, end - begin - 4));
+        }();
+        return name.c_str();
+    }
+
+    // TypeName для путей без исключений: если память под имя не выделилась, имя пустое
+    template <typename T>
+    const char *TypeNameOrEmpty() noexcept
+    {
+        try
+        {
+            return TypeName<T>();
+        }
+        catch (...)
+        {
+            return "";
+        }
+    }
+
+    inline uint64_t NowNs() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    inline void AtomicMax(std::atomic<uint64_t> &target, uint64_t value) noexcept
+    {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Сводка по месту создания векторов. Обновляется из любых потоков
+    struct Site
+    {
+        std::string file;
+        unsigned line = 0;
+        std::string tag;
+
+        std::atomic<uint64_t> instances{0};
+        std::atomic<uint64_t> live_instances{0};
+        std::atomic<uint64_t> reallocations{0};
+        std::atomic<uint64_t> bytes_allocated{0};
+        std::atomic<uint64_t> bytes_relocated{0};
+        std::atomic<uint64_t> relocation_ns{0};
+        std::atomic<uint64_t> peak_capacity_bytes{0};
+        // Ёмкость сверх размера у разрушенных экземпляров: сумма и максимум
+        std::atomic<uint64_t> wasted_bytes{0};
+        std::atomic<uint64_t> peak_wasted_bytes{0};
+        std::atomic<uint64_t> first_growth_ns{0};
+        std::atomic<uint64_t> last_growth_ns{0};
+    };
+
+    // Место векторов, созданных вне VectorStatsScope. Размещается статически, а не в реестре:
+    // его получают из noexcept-конструкторов Vector, где нельзя выделять память и брать блокировку.
+    // Не разрушается по той же причине, что и реестр
+    inline Site &UnscopedSite() noexcept
+    {
+        alignas(Site) static unsigned char storage[sizeof(Site)];
+        static Site *site = [] {
+            Site *unscoped = new (storage) Site();
+            unscoped->tag = "unscoped";
+            return unscoped;
+        }();
+        return *site;
+    }
+
+    class Registry
+    {
+    public:
+        static Registry &Instance()
+        {
+            // Не разрушается: векторы в статических объектах могут пережить реестр
+            static Registry *registry = new Registry();
+            return *registry;
+        }
+
+        Site &GetSite(const char *file, unsigned line, const char *tag)
+        {
+            std::lock_guard lock(mutex_);
+            auto &site = sites_[std::make_tuple(std::string(file), line, std::string(tag))];
+            if (!site)
+            {
+                site = std::make_unique<Site>();
+                site->file = file;
+                site->line = line;
+                site->tag = tag;
+            }
+            return *site;
+        }
+
+        template <typename F>
+        void ForEachSite(F &&fn)
+        {
+            // Место без области попадает в выгрузку, только если им пользовались
+            if (UnscopedSite().instances.load(std::memory_order_relaxed) != 0)
+            {
+                fn(UnscopedSite());
+            }
+            std::lock_guard lock(mutex_);
+            for (const auto &[key, site] : sites_)
+            {
+                fn(*site);
+            }
+        }
+
+    private:
+        std::mutex mutex_;
+        std::map<std::tuple<std::string, unsigned, std::string>, std::unique_ptr<Site>> sites_;
+    };
+
+    inline Site *&CurrentSite() noexcept
+    {
+        thread_local Site *current = nullptr;
+        return current;
+    }
+
+    inline Site &ActiveSite() noexcept
+    {
+        Site *site = CurrentSite();
+        return site != nullptr ? *site : UnscopedSite();
+    }
+
+    // Счётчики экземпляра; база Vector
+    class Instance
+    {
+    public:
+        Instance()
+            : site_(&ActiveSite())
+        {
+            site_->instances.fetch_add(1, std::memory_order_relaxed);
+            site_->live_instances.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Счётчики принадлежат объекту и не копируются
+        Instance(const Instance &)
+            : Instance()
+        {
+        }
+
+        Instance &operator=(const Instance &) noexcept
+        {
+            return *this;
+        }
+
+    protected:
+        ~Instance() = default;
+
+        VectorStats Counters() const noexcept
+        {
+            return counters_;
+        }
+
+        void OnDestroy(size_t capacity_bytes, size_t size_bytes) noexcept
+        {
+            const uint64_t wasted = capacity_bytes - size_bytes;
+            site_->wasted_bytes.fetch_add(wasted, std::memory_order_relaxed);
+            AtomicMax(site_->peak_wasted_bytes, wasted);
+            site_->live_instances.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+    private:
+        friend class GrowthEvent;
+
+        Site *site_;
+        VectorStats counters_;
+    };
+
+    // Событие роста: создаётся перед выделением нового буфера, в деструкторе записывает
+    // счётчики и время переноса. Рост, прерванный исключением, не учитывается
+    class GrowthEvent
+    {
+    public:
+        template <typename T>
+        GrowthEvent(Instance &instance, size_t old_capacity, size_t new_capacity, size_t relocated,
+                    Element<T>) noexcept
+            : instance_(instance),
+              old_capacity_(old_capacity),
+              new_capacity_(new_capacity),
+              relocated_(relocated),
+              element_size_(sizeof(T)),
+              type_name_(TypeNameOrEmpty<T>()),
+              exceptions_(std::uncaught_exceptions()),
+              start_ns_(NowNs())
+        {
+        }
+
+        GrowthEvent(const GrowthEvent &) = delete;
+        GrowthEvent &operator=(const GrowthEvent &) = delete;
+
+        ~GrowthEvent()
+        {
+            if (std::uncaught_exceptions() != exceptions_)
+            {
+                return;
+            }
+            const uint64_t end_ns = NowNs();
+            const uint64_t new_bytes = new_capacity_ * element_size_;
+            const uint64_t relocated_bytes = relocated_ * element_size_;
+
+            VectorStats &counters = instance_.counters_;
+            counters.reallocations += 1;
+            counters.bytes_allocated += new_bytes;
+            counters.bytes_relocated += relocated_bytes;
+            counters.peak_capacity_bytes = std::max<uint64_t>(counters.peak_capacity_bytes, new_bytes);
+            if (counters.first_growth_ns == 0)
+            {
+                counters.first_growth_ns = end_ns;
+            }
+            counters.last_growth_ns = end_ns;
+
+            Site &site = *instance_.site_;
+            site.reallocations.fetch_add(1, std::memory_order_relaxed);
+            site.bytes_allocated.fetch_add(new_bytes, std::memory_order_relaxed);
+            site.bytes_relocated.fetch_add(relocated_bytes, std::memory_order_relaxed);
+            site.relocation_ns.fetch_add(end_ns - start_ns_, std::memory_order_relaxed);
+            AtomicMax(site.peak_capacity_bytes, new_bytes);
+            uint64_t expected = 0;
+            site.first_growth_ns.compare_exchange_strong(expected, end_ns, std::memory_order_relaxed);
+            AtomicMax(site.last_growth_ns, end_ns);
+
+#ifdef VECTOR_ENABLE_TRACING
+            // Первая запись потока выделяет его кольцо. Деструктор не бросает,
+            // поэтому при ошибке запись теряется
+            try
+            {
+                // Метка — область, где вектор вырос, а не где он создан
+                vector_trace::GrowthRecord record;
+                record.start_ns = start_ns_;
+                record.duration_ns = end_ns - start_ns_;
+                record.old_capacity = old_capacity_;
+                record.new_capacity = new_capacity_;
+                record.element_size = element_size_;
+                record.type_name = type_name_;
+                record.tag = ActiveSite().tag.c_str();
+                vector_trace::Record(record);
+            }
+            catch (...)
+            {
+            }
+#endif
+        }
+
+    private:
+        Instance &instance_;
+        size_t old_capacity_;
+        size_t new_capacity_;
+        size_t relocated_;
+        size_t element_size_;
+        const char *type_name_;
+        int exceptions_;
+        uint64_t start_ns_;
+    };
+
+    inline void WriteJsonString(std::ostream &out, const std::string &s)
+    {
+        out << '"';
+        for (const char c : s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                out << ' ';
+            }
+            else
+            {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    // Выгружает все места в JSON-массив
+    inline void DumpJson(std::ostream &out)
+    {
+        out << "[";
+        bool first = true;
+        Registry::Instance().ForEachSite([&](const Site &site) {
+            out << (first ? "\n" : ",\n") << "  {\"file\": ";
+            first = false;
+            WriteJsonString(out, site.file);
+            out << ", \"line\": " << site.line << ", \"tag\": ";
+            WriteJsonString(out, site.tag);
+            const auto field = [&](const char *name, const std::atomic<uint64_t> &value) {
+                out << ", \"" << name << "\": " << value.load(std::memory_order_relaxed);
+            };
+            field("instances", site.instances);
+            field("live_instances", site.live_instances);
+            field("reallocations", site.reallocations);
+            field("bytes_allocated", site.bytes_allocated);
+            field("bytes_relocated", site.bytes_relocated);
+            field("relocation_ns", site.relocation_ns);
+            field("peak_capacity_bytes", site.peak_capacity_bytes);
+            field("wasted_bytes", site.wasted_bytes);
+            field("peak_wasted_bytes", site.peak_wasted_bytes);
+            field("first_growth_ns", site.first_growth_ns);
+            field("last_growth_ns", site.last_growth_ns);
+            out << "}";
+        });
+        out << "\n]\n";
+    }
+
+#else
+    inline constexpr bool kEnabled = false;
+
+    class Instance
+    {
+    protected:
+        VectorStats Counters() const noexcept
+        {
+            return {};
+        }
+
+        void OnDestroy(size_t /*capacity_bytes*/, size_t /*size_bytes*/) noexcept
+        {
+        }
+    };
+
+    class GrowthEvent
+    {
+    public:
+        template <typename T>
+        GrowthEvent(Instance & /*instance*/, size_t /*old_capacity*/, size_t /*new_capacity*/, size_t /*relocated*/,
+                    Element<T>) noexcept
+        {
+        }
+    };
+#endif
+
+} // namespace vector_stats
+
+// Приписывает векторы, создаваемые в потоке до конца области видимости, месту её объявления
+class VectorStatsScope
+{
+public:
+#ifdef VECTOR_ENABLE_STATS
+    explicit VectorStatsScope(const char *tag = "", const char *file = __builtin_FILE(),
+                              unsigned line = __builtin_LINE())
+        : previous_(vector_stats::CurrentSite())
+    {
+        vector_stats::CurrentSite() = &vector_stats::Registry::Instance().GetSite(file, line, tag);
+    }
+
+    ~VectorStatsScope()
+    {
+        vector_stats::CurrentSite() = previous_;
+    }
+
+private:
+    vector_stats::Site *previous_;
+#else
+    explicit VectorStatsScope(const char * /*tag*/ = "")
+    {
+    }
+#endif
+
+public:
+    VectorStatsScope(const VectorStatsScope &) = delete;
+    VectorStatsScope &operator=(const VectorStatsScope &) = delete;
+};
@@ -0,0 +1,377 @@
+#pragma once
+#include "vector.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Потоковая запись и чтение массивов, не помещающихся в память.
+// Файл — просто элементы T подряд; работа идёт кусками по chunk_size элементов.
+// У писателя и читателя по два буфера Vector<T>: пока один заполняется или обрабатывается,
+// второй пишется на диск или читается с диска фоновым потоком. Буферы переиспользуются
+// между кусками и не перевыделяются.
+
+namespace vector_stream
+{
+    [[noreturn]] inline void ThrowSystemError(const char *what)
+    {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    inline void WriteAll(int fd, const void *data, size_t size)
+    {
+        auto bytes = static_cast<const char *>(data);
+        while (size != 0)
+        {
+            const ssize_t written = ::write(fd, bytes, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                ThrowSystemError("write");
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    // Читает до size байт, меньше — только в конце файла
+    inline size_t ReadAll(int fd, void *data, size_t size)
+    {
+        auto bytes = static_cast<char *>(data);
+        size_t total = 0;
+        while (total != size)
+        {
+            const ssize_t got = ::read(fd, bytes + total, size - total);
+            if (got < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                ThrowSystemError("read");
+            }
+            if (got == 0)
+            {
+                break;
+            }
+            total += static_cast<size_t>(got);
+        }
+        return total;
+    }
+
+    // Фоновый поток, выполняющий по одному заданию за раз. Исключение из задания
+    // сохраняется и перебрасывается в Wait()
+    class Worker
+    {
+    public:
+        template <typename F>
+        explicit Worker(F &&job)
+            : job_(std::forward<F>(job)), thread_([this] {
+                  Run();
+              })
+        {
+        }
+
+        Worker(const Worker &) = delete;
+        Worker &operator=(const Worker &) = delete;
+
+        ~Worker()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            thread_.join();
+        }
+
+        // Запускает задание; предыдущее должно быть завершено через Wait()
+        void Start()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                busy_ = true;
+            }
+            cv_.notify_all();
+        }
+
+        void Wait()
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [this] {
+                return !busy_;
+            });
+            if (error_)
+            {
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+        }
+
+    private:
+        void Run()
+        {
+            std::unique_lock lock(mutex_);
+            while (true)
+            {
+                cv_.wait(lock, [this] {
+                    return busy_ || stop_;
+                });
+                if (!busy_)
+                {
+                    return;
+                }
+                lock.unlock();
+                std::exception_ptr error;
+                try
+                {
+                    job_();
+                }
+                catch (...)
+                {
+                    error = std::current_exception();
+                }
+                lock.lock();
+                error_ = error;
+                busy_ = false;
+                cv_.notify_all();
+            }
+        }
+
+        std::function<void()> job_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool busy_ = false;
+        bool stop_ = false;
+        std::exception_ptr error_;
+        std::thread thread_;
+    };
+
+} // namespace vector_stream
+
+template <typename T>
+class VectorStreamWriter
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Streamed elements are written as raw bytes");
+
+public:
+    VectorStreamWriter(const std::string &path, size_t chunk_size)
+        : chunk_size_(chunk_size), worker_([this] {
+              vector_stream::WriteAll(fd_, spill_.begin(), spill_.Size() * sizeof(T));
+          })
+    {
+        assert(chunk_size_ != 0);
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            vector_stream::ThrowSystemError("open");
+        }
+        active_.Reserve(chunk_size_);
+        spill_.Reserve(chunk_size_);
+    }
+
+    VectorStreamWriter(const VectorStreamWriter &) = delete;
+    VectorStreamWriter &operator=(const VectorStreamWriter &) = delete;
+
+    // Дописывает хвост. Ошибки записи при разрушении теряются — вызывайте Close() явно
+    ~VectorStreamWriter()
+    {
+        try
+        {
+            Close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    void PushBack(const T &value)
+    {
+        active_.PushBack(value);
+        ++size_;
+        if (active_.Size() == chunk_size_)
+        {
+            Spill();
+        }
+    }
+
+    void Append(const T *data, size_t count)
+    {
+        while (count != 0)
+        {
+            const size_t take = std::min(count, chunk_size_ - active_.Size());
+            // Буфер зарезервирован под кусок, так что PushBack не перевыделяет память;
+            // Resize с последующим копированием записал бы каждый элемент дважды
+            for (const T *end = data + take; data != end; ++data)
+            {
+                active_.PushBack(*data);
+            }
+            count -= take;
+            size_ += take;
+            if (active_.Size() == chunk_size_)
+            {
+                Spill();
+            }
+        }
+    }
+
+    void Append(const Vector<T> &values)
+    {
+        Append(values.begin(), values.Size());
+    }
+
+    // Количество принятых элементов, включая ещё не записанные
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    // Записывает неполный последний кусок и закрывает файл
+    void Close()
+    {
+        if (fd_ < 0)
+        {
+            return;
+        }
+        if (active_.Size() != 0)
+        {
+            Spill();
+        }
+        // Фоновая запись использует fd_, поэтому дескриптор освобождается только после неё
+        std::exception_ptr error;
+        try
+        {
+            worker_.Wait();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        const int fd = std::exchange(fd_, -1);
+        if (error)
+        {
+            ::close(fd);
+            std::rethrow_exception(error);
+        }
+        if (::close(fd) != 0)
+        {
+            vector_stream::ThrowSystemError("close");
+        }
+    }
+
+private:
+    // Отдаёт заполненный буфер фоновому потоку, дождавшись записи предыдущего
+    void Spill()
+    {
+        worker_.Wait();
+        active_.Swap(spill_);
+        active_.Resize(0);
+        worker_.Start();
+    }
+
+    int fd_ = -1;
+    size_t chunk_size_;
+    size_t size_ = 0;
+    Vector<T> active_;
+    Vector<T> spill_;
+    vector_stream::Worker worker_;
+};
+
+template <typename T>
+class VectorStreamReader
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Streamed elements are read as raw bytes");
+
+public:
+    VectorStreamReader(const std::string &path, size_t chunk_size)
+        : chunk_size_(chunk_size), worker_([this] {
+              Prefetch();
+          })
+    {
+        assert(chunk_size_ != 0);
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0)
+        {
+            vector_stream::ThrowSystemError("open");
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        current_.Reserve(chunk_size_);
+        next_.Reserve(chunk_size_);
+        worker_.Start();
+    }
+
+    VectorStreamReader(const VectorStreamReader &) = delete;
+    VectorStreamReader &operator=(const VectorStreamReader &) = delete;
+
+    ~VectorStreamReader()
+    {
+        try
+        {
+            worker_.Wait();
+        }
+        catch (...)
+        {
+        }
+        ::close(fd_);
+    }
+
+    // Переходит к следующему куску; false — файл закончился.
+    // Пока вызывающий обрабатывает Chunk(), фоновый поток уже читает следующий
+    bool Next()
+    {
+        worker_.Wait();
+        if (next_.Size() == 0)
+        {
+            current_.Resize(0);
+            return false;
+        }
+        current_.Swap(next_);
+        worker_.Start();
+        return true;
+    }
+
+    const Vector<T> &Chunk() const noexcept
+    {
+        return current_;
+    }
+
+private:
+    // Буферы сохраняют размер chunk_size_ между кусками: Resize обнуляет новые элементы,
+    // поэтому лишний проход записи бывает только при первом чтении в каждый буфер и после
+    // укороченного последнего куска
+    void Prefetch()
+    {
+        if (next_.Size() != chunk_size_)
+        {
+            next_.Resize(chunk_size_);
+        }
+        const size_t bytes = vector_stream::ReadAll(fd_, next_.begin(), chunk_size_ * sizeof(T));
+        if (bytes % sizeof(T) != 0)
+        {
+            throw std::runtime_error("VectorStreamReader: file size is not a multiple of the element size");
+        }
+        next_.Resize(bytes / sizeof(T));
+    }
+
+    int fd_ = -1;
+    size_t chunk_size_;
+    Vector<T> current_;
+    Vector<T> next_;
+    vector_stream::Worker worker_;
+};
@@ -0,0 +1,321 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include <unistd.h>
+
+// Трассировка роста Vector. Включается макросом VECTOR_ENABLE_TRACING (он же включает
+// VECTOR_ENABLE_STATS) и питается тем же событием роста vector_stats::GrowthEvent.
+//
+// Каждое перевыделение пишется в кольцевой буфер своего потока без блокировок и
+// обновляет общую гистограмму; необязательный обратный вызов получает события
+// не короче заданного порога. Буферы всех потоков выгружаются в формате Chrome trace
+// (chrome://tracing, Perfetto):
+//
+//     vector_trace::SetCallback(+[](const vector_trace::GrowthRecord &r) { ... }, 50'000);
+//     ...
+//     vector_trace::ExportChromeTrace(file);
+namespace vector_trace
+{
+    // Одно перевыделение. Строки статические: имя типа и метка VectorStatsScope
+    struct GrowthRecord
+    {
+        uint64_t start_ns = 0;
+        uint64_t duration_ns = 0;
+        uint64_t old_capacity = 0;
+        uint64_t new_capacity = 0;
+        uint64_t element_size = 0;
+        const char *type_name = "";
+        const char *tag = "";
+    };
+
+    using Callback = void (*)(const GrowthRecord &record);
+
+    inline constexpr size_t kRingSize = 1024;
+    // Гистограммы по степеням двойки: байты новой ёмкости и время переноса в нс
+    inline constexpr size_t kHistogramBuckets = 48;
+
+    inline size_t Log2Bucket(uint64_t value) noexcept
+    {
+        const size_t bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+        return bucket < kHistogramBuckets ? bucket : kHistogramBuckets - 1;
+    }
+
+    // Кольцо одного потока. Пишет только владелец; читатель копирует записи и отбрасывает
+    // те, что могли быть перезаписаны за время копирования. Поля атомарны, чтобы чтение
+    // параллельно с записью не было гонкой
+    class Ring
+    {
+    public:
+        struct Slot
+        {
+            std::atomic<uint64_t> start_ns{0};
+            std::atomic<uint64_t> duration_ns{0};
+            std::atomic<uint64_t> old_capacity{0};
+            std::atomic<uint64_t> new_capacity{0};
+            std::atomic<uint64_t> element_size{0};
+            std::atomic<const char *> type_name{""};
+            std::atomic<const char *> tag{""};
+        };
+
+        void Push(const GrowthRecord &record) noexcept
+        {
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            Slot &slot = slots_[head % kRingSize];
+            // Сначала объявляем слот занятым, чтобы читатель не взял его наполовину записанным
+            written_.store(head + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.start_ns.store(record.start_ns, std::memory_order_relaxed);
+            slot.duration_ns.store(record.duration_ns, std::memory_order_relaxed);
+            slot.old_capacity.store(record.old_capacity, std::memory_order_relaxed);
+            slot.new_capacity.store(record.new_capacity, std::memory_order_relaxed);
+            slot.element_size.store(record.element_size, std::memory_order_relaxed);
+            slot.type_name.store(record.type_name, std::memory_order_relaxed);
+            slot.tag.store(record.tag, std::memory_order_relaxed);
+            head_.store(head + 1, std::memory_order_release);
+        }
+
+        // Вызывает fn для сохранившихся записей от старых к новым
+        template <typename F>
+        void ForEach(F &&fn) const
+        {
+            const uint64_t head = head_.load(std::memory_order_acquire);
+            const uint64_t first = head > kRingSize ? head - kRingSize : 0;
+            for (uint64_t i = first; i < head; ++i)
+            {
+                const Slot &slot = slots_[i % kRingSize];
+                GrowthRecord record;
+                record.start_ns = slot.start_ns.load(std::memory_order_relaxed);
+                record.duration_ns = slot.duration_ns.load(std::memory_order_relaxed);
+                record.old_capacity = slot.old_capacity.load(std::memory_order_relaxed);
+                record.new_capacity = slot.new_capacity.load(std::memory_order_relaxed);
+                record.element_size = slot.element_size.load(std::memory_order_relaxed);
+                record.type_name = slot.type_name.load(std::memory_order_relaxed);
+                record.tag = slot.tag.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // Писатель успел обогнать нас на целое кольцо — запись могла смешаться с новой
+                if (written_.load(std::memory_order_relaxed) > i + kRingSize)
+                {
+                    continue;
+                }
+                fn(record);
+            }
+        }
+
+        uint64_t Recorded() const noexcept
+        {
+            return head_.load(std::memory_order_relaxed);
+        }
+
+        uint32_t ThreadId() const noexcept
+        {
+            return thread_id_;
+        }
+
+    private:
+        friend class RingList;
+
+        Slot slots_[kRingSize];
+        std::atomic<uint64_t> head_{0};
+        std::atomic<uint64_t> written_{0};
+        uint32_t thread_id_ = 0;
+        std::atomic<bool> owned_{false};
+        Ring *next_ = nullptr;
+    };
+
+    // Список колец всех потоков. Кольца не освобождаются: записи завершившегося потока
+    // остаются доступны для выгрузки, а само кольцо достаётся следующему новому потоку
+    class RingList
+    {
+    public:
+        static RingList &Instance()
+        {
+            static RingList *list = new RingList();
+            return *list;
+        }
+
+        Ring &Acquire()
+        {
+            const uint32_t thread_id = next_thread_id_.fetch_add(1, std::memory_order_relaxed) + 1;
+            for (Ring *ring = head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+            {
+                bool expected = false;
+                if (ring->owned_.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+                {
+                    ring->thread_id_ = thread_id;
+                    return *ring;
+                }
+            }
+            Ring *ring = new Ring();
+            ring->owned_.store(true, std::memory_order_relaxed);
+            ring->thread_id_ = thread_id;
+            ring->next_ = head_.load(std::memory_order_relaxed);
+            while (!head_.compare_exchange_weak(ring->next_, ring, std::memory_order_release,
+                                                std::memory_order_relaxed))
+            {
+            }
+            return *ring;
+        }
+
+        void Release(Ring &ring) noexcept
+        {
+            ring.owned_.store(false, std::memory_order_release);
+        }
+
+        template <typename F>
+        void ForEach(F &&fn) const
+        {
+            for (const Ring *ring = head_.load(std::memory_order_acquire); ring != nullptr; ring = ring->next_)
+            {
+                fn(*ring);
+            }
+        }
+
+    private:
+        std::atomic<Ring *> head_{nullptr};
+        std::atomic<uint32_t> next_thread_id_{0};
+    };
+
+    inline Ring &ThreadRing()
+    {
+        struct Holder
+        {
+            Ring &ring = RingList::Instance().Acquire();
+
+            ~Holder()
+            {
+                RingList::Instance().Release(ring);
+            }
+        };
+        thread_local Holder holder;
+        return holder.ring;
+    }
+
+    struct Histogram
+    {
+        std::atomic<uint64_t> capacity_bytes[kHistogramBuckets] = {};
+        std::atomic<uint64_t> duration_ns[kHistogramBuckets] = {};
+    };
+
+    inline Histogram &GlobalHistogram() noexcept
+    {
+        static Histogram histogram;
+        return histogram;
+    }
+
+    struct CallbackState
+    {
+        std::atomic<Callback> callback{nullptr};
+        std::atomic<uint64_t> threshold_ns{0};
+    };
+
+    inline CallbackState &GlobalCallback() noexcept
+    {
+        static CallbackState state;
+        return state;
+    }
+
+    // Обратный вызов для перевыделений не короче threshold_ns; nullptr отключает.
+    // Вызывается в потоке, где вырос вектор, сразу после переноса
+    inline void SetCallback(Callback callback, uint64_t threshold_ns = 0) noexcept
+    {
+        GlobalCallback().threshold_ns.store(threshold_ns, std::memory_order_relaxed);
+        GlobalCallback().callback.store(callback, std::memory_order_release);
+    }
+
+    // Точка входа из vector_stats::GrowthEvent
+    inline void Record(const GrowthRecord &record)
+    {
+        ThreadRing().Push(record);
+
+        Histogram &histogram = GlobalHistogram();
+        histogram.capacity_bytes[Log2Bucket(record.new_capacity * record.element_size)].fetch_add(
+            1, std::memory_order_relaxed);
+        histogram.duration_ns[Log2Bucket(record.duration_ns)].fetch_add(1, std::memory_order_relaxed);
+
+        const CallbackState &state = GlobalCallback();
+        if (const Callback callback = state.callback.load(std::memory_order_acquire);
+            callback != nullptr && record.duration_ns >= state.threshold_ns.load(std::memory_order_relaxed))
+        {
+            callback(record);
+        }
+    }
+
+    // Записи всех потоков: fn(номер потока, запись)
+    template <typename F>
+    void ForEachRecord(F &&fn)
+    {
+        RingList::Instance().ForEach([&](const Ring &ring) {
+            ring.ForEach([&](const GrowthRecord &record) {
+                fn(ring.ThreadId(), record);
+            });
+        });
+    }
+
+    inline void WriteJsonString(std::ostream &out, const char *s)
+    {
+        out << '"';
+        for (; *s != '\0'; ++s)
+        {
+            if (*s == '"' || *s == '\\')
+            {
+                out << '\\' << *s;
+            }
+            else if (static_cast<unsigned char>(*s) >= 0x20)
+            {
+                out << *s;
+            }
+        }
+        out << '"';
+    }
+
+    inline void WriteMicros(std::ostream &out, uint64_t ns)
+    {
+        const uint64_t fraction = ns % 1000;
+        out << ns / 1000 << '.' << fraction / 100 << fraction / 10 % 10 << fraction % 10;
+    }
+
+    // Выгружает записи как завершённые события ("ph": "X"); время в микросекундах
+    inline void ExportChromeTrace(std::ostream &out)
+    {
+        const long pid = static_cast<long>(getpid());
+        out << "{\"traceEvents\": [";
+        bool first = true;
+        ForEachRecord([&](uint32_t thread_id, const GrowthRecord &record) {
+            out << (first ? "\n" : ",\n") << "  {\"name\": ";
+            first = false;
+            WriteJsonString(out, record.type_name);
+            out << ", \"cat\": \"vector_growth\", \"ph\": \"X\", \"ts\": ";
+            WriteMicros(out, record.start_ns);
+            out << ", \"dur\": ";
+            WriteMicros(out, record.duration_ns);
+            out << ", \"pid\": " << pid << ", \"tid\": " << thread_id << ", \"args\": {\"old_capacity\": "
+                << record.old_capacity
+                << ", \"new_capacity\": " << record.new_capacity << ", \"element_size\": " << record.element_size
+                << ", \"tag\": ";
+            WriteJsonString(out, record.tag);
+            out << "}}";
+        });
+        out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+    }
+
+    // Гистограмма в текстовом виде: корзина [2^(k-1), 2^k) и число событий
+    inline void PrintHistogram(std::ostream &out)
+    {
+        const auto print = [&](const char *title, const std::atomic<uint64_t> *buckets) {
+            out << title << '\n';
+            for (size_t k = 0; k < kHistogramBuckets; ++k)
+            {
+                if (const uint64_t count = buckets[k].load(std::memory_order_relaxed); count != 0)
+                {
+                    out << "  < 2^" << k << ": " << count << '\n';
+                }
+            }
+        };
+        print("new capacity, bytes:", GlobalHistogram().capacity_bytes);
+        print("relocation time, ns:", GlobalHistogram().duration_ns);
+    }
+
+} // namespace vector_trace